@@ -0,0 +1,33 @@
+#ifndef BENCH_H_INCLUDED
+#define BENCH_H_INCLUDED
+
+#include <stdio.h>
+#include <time.h>
+
+/* Wall clock of the host benchmarks. It measures the code of the library on the host CPU, so the absolute numbers are much smaller than
+   on the ESP8266, only the comparisons are meaningful.
+*/
+class Stopwatch
+{
+public:
+	Stopwatch() { start(); }
+
+	void start()
+	{
+		clock_gettime(CLOCK_MONOTONIC, &m_startTime);
+	}
+
+	//! Returns the elapsed time since start() divided by the number of iterations, in nanoseconds
+	double getNsPerIteration(long iNrOfIterations) const
+	{
+		struct timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		double dElapsedNs = (now.tv_sec - m_startTime.tv_sec) * 1e9 + (now.tv_nsec - m_startTime.tv_nsec);
+		return dElapsedNs / iNrOfIterations;
+	}
+
+private:
+	struct timespec m_startTime;
+};
+
+#endif
@@ -0,0 +1,78 @@
+/* Cost of connect() + disconnect(), and of queueing a slot, when the tables are 90% full: the free entries are taken from a free stack, so
+   the cost shouldn't depend on the occupancy. The Makefile builds it with a low priority queue of 100 entries.
+*/
+
+#include "Bench.h"
+#include "SdkSim.h"
+#include "Signal.h"
+
+using namespace Esp8266Base;
+
+namespace
+{
+
+const int NR_OF_USED_CONNECTIONS = MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS * 9 / 10;
+const int NR_OF_PENDING_CALLS = MAX_NR_OF_QUEUED_SIGNALS * 9 / 10;
+const long NR_OF_ITERATIONS = 1000000;
+
+class Receiver
+{
+public:
+	Receiver() : m_iNrOfCalls(0) {}
+
+	void slot(void*)
+	{
+		++m_iNrOfCalls;
+	}
+
+	void otherSlot(void*)
+	{
+		++m_iNrOfCalls;
+	}
+
+	int m_iNrOfCalls;
+};
+
+Signal g_arraySignals[NR_OF_USED_CONNECTIONS];
+Receiver g_receiver;
+
+} // namespace
+
+
+int main()
+{
+	// the used connections: the last one is queued, and it has the pending calls
+	for (int i = 0; i < NR_OF_USED_CONNECTIONS - 1; ++i)
+	{
+		g_arraySignals[i].connect(&g_receiver, &Receiver::slot, SignalBase::DirectConnection);
+	}
+	Signal& queuedSignal = g_arraySignals[NR_OF_USED_CONNECTIONS - 1];
+	queuedSignal.connect(&g_receiver, &Receiver::slot, SignalBase::QueuedConnection);
+	for (int i = 0; i < NR_OF_PENDING_CALLS; ++i)
+	{
+		queuedSignal.emit(NULL);
+	}
+
+	Signal signal;
+	Stopwatch stopwatch;
+	for (long i = 0; i < NR_OF_ITERATIONS; ++i)
+	{
+		signal.connect(&g_receiver, &Receiver::otherSlot, SignalBase::DirectConnection);
+		signal.disconnect(&g_receiver, &Receiver::otherSlot);
+	}
+	double dNsPerConnect = stopwatch.getNsPerIteration(NR_OF_ITERATIONS);
+
+	// each emit queues a call, and the task calls the oldest one, so the number of pending calls stays the same
+	stopwatch.start();
+	for (long i = 0; i < NR_OF_ITERATIONS; ++i)
+	{
+		queuedSignal.emit(NULL);
+		SdkSim::runTask();
+	}
+	double dNsPerQueuedCall = stopwatch.getNsPerIteration(NR_OF_ITERATIONS);
+
+	printf("connect() + disconnect() with %d of %d connections used: %.1f ns\n", NR_OF_USED_CONNECTIONS, MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS,
+	       dNsPerConnect);
+	printf("queued emit() + task with %d of %d calls pending: %.1f ns\n", NR_OF_PENDING_CALLS, MAX_NR_OF_QUEUED_SIGNALS, dNsPerQueuedCall);
+	return (g_receiver.m_iNrOfCalls == NR_OF_ITERATIONS) ? 0 : 1;
+}
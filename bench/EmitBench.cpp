@@ -0,0 +1,71 @@
+/* Latency of emit() for a signal with a few direct connections, while the rest of the connection table is used by other signals.
+   The Makefile builds it with MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS of 10, 100 and 1000: emit() walks only the connections of its own
+   signal, so the latency shouldn't grow with the size of the table.
+*/
+
+#include "Bench.h"
+#include "SdkSim.h"
+#include "Signal.h"
+
+using namespace Esp8266Base;
+
+namespace
+{
+
+const int NR_OF_OWN_CONNECTIONS = 5;
+const int NR_OF_OTHER_CONNECTIONS = MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS - NR_OF_OWN_CONNECTIONS;
+const long NR_OF_EMITS = 2000000;
+
+class Receiver
+{
+public:
+	Receiver() : m_iNrOfCalls(0) {}
+
+	void slot(void*)
+	{
+		++m_iNrOfCalls;
+	}
+
+	int m_iNrOfCalls;
+};
+
+Signal g_signal;
+Signal g_arrayOtherSignals[NR_OF_OTHER_CONNECTIONS];
+Receiver g_receiver;
+
+} // namespace
+
+
+int main()
+{
+	// the own connections are spread over the table, between the connections of the other signals
+	int iNextOther = 0;
+	for (int i = 0; i < NR_OF_OWN_CONNECTIONS; ++i)
+	{
+		for (int j = 0; j < NR_OF_OTHER_CONNECTIONS / NR_OF_OWN_CONNECTIONS; ++j, ++iNextOther)
+		{
+			g_arrayOtherSignals[iNextOther].connect(&g_receiver, &Receiver::slot, SignalBase::DirectConnection);
+		}
+		g_signal.connect(&g_receiver, &Receiver::slot, SignalBase::DirectConnection);
+	}
+	for (; iNextOther < NR_OF_OTHER_CONNECTIONS; ++iNextOther)
+	{
+		g_arrayOtherSignals[iNextOther].connect(&g_receiver, &Receiver::slot, SignalBase::DirectConnection);
+	}
+	if (SignalBase::getNrOfConnections() != MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS)
+	{
+		printf("EmitBench: the connection table isn't full\n");
+		return 1;
+	}
+
+	Stopwatch stopwatch;
+	for (long i = 0; i < NR_OF_EMITS; ++i)
+	{
+		g_signal.emit(NULL);
+	}
+	double dNsPerEmit = stopwatch.getNsPerIteration(NR_OF_EMITS);
+
+	printf("emit() with %d direct slots, %d connections in the table: %.1f ns\n", NR_OF_OWN_CONNECTIONS, MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS,
+	       dNsPerEmit);
+	return (g_receiver.m_iNrOfCalls == NR_OF_EMITS * NR_OF_OWN_CONNECTIONS) ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+/* Wake ups of a battery node with and without timer slack, in one simulated hour: 6 sensors are read periodically (250 ms to 5 s), each
+   reading waits 15 ms for the conversion, and 3 heartbeats are sent every 10 to 60 s. With slack, the periods may expire 10% later, and
+   the conversions 5 ms later. Each os_timer callback is a wake up. The Makefile builds it for both backends.
+*/
+
+#include "Bench.h"
+#include "SdkSim.h"
+#include "Timer.h"
+
+using namespace Esp8266Base;
+
+namespace
+{
+
+const int NR_OF_SENSORS = 6;
+const int arraySensorPeriodsMs[NR_OF_SENSORS] = { 250, 500, 1000, 1000, 2000, 5000 };
+const int NR_OF_HEARTBEATS = 3;
+const int arrayHeartbeatPeriodsMs[NR_OF_HEARTBEATS] = { 10000, 30000, 60000 };
+
+// the timers aren't started at the same time (e.g. each sensor is found later)
+const uint64 arrayStartOffsetsUs[NR_OF_SENSORS + NR_OF_HEARTBEATS] = { 0, 137250, 411020, 523400, 702310, 855555, 902001, 960330, 987650 };
+
+const int CONVERSION_MS = 15;
+const int CONVERSION_SLACK_MS = 5;
+const uint64 DURATION_US = (uint64)3600 * 1000 * 1000;
+
+class Sensor
+{
+public:
+	Sensor() : m_iSlackMs(0), m_iNrOfReadings(0), m_uMaxConversionJitterUs(0) {}
+
+	void start(int iPeriodMs, bool bSlack)
+	{
+		m_iSlackMs = bSlack ? CONVERSION_SLACK_MS : 0;
+		m_period.timeOut.connect(this, &Sensor::startConversion, SignalBase::DirectConnection);
+		m_conversion.timeOut.connect(this, &Sensor::read, SignalBase::DirectConnection);
+		m_period.startPeriodic(iPeriodMs, Timer::SkipMissedPeriods, NULL, bSlack ? iPeriodMs / 10 : 0);
+	}
+
+	void startConversion(void*)
+	{
+		m_conversion.start(CONVERSION_MS, false, NULL, m_iSlackMs);
+	}
+
+	void read(void*)
+	{
+		++m_iNrOfReadings;
+		if (m_conversion.getMaxJitterUs() > m_uMaxConversionJitterUs)
+		{
+			m_uMaxConversionJitterUs = m_conversion.getMaxJitterUs();
+		}
+	}
+
+	Timer m_period;
+	Timer m_conversion;
+	int m_iSlackMs;
+	int m_iNrOfReadings;
+	uint32 m_uMaxConversionJitterUs;
+};
+
+class Heartbeat
+{
+public:
+	Heartbeat() : m_iNrOfBeats(0) {}
+
+	void start(int iPeriodMs, bool bSlack)
+	{
+		m_timer.timeOut.connect(this, &Heartbeat::beat, SignalBase::DirectConnection);
+		m_timer.startPeriodic(iPeriodMs, Timer::SkipMissedPeriods, NULL, bSlack ? iPeriodMs / 10 : 0);
+	}
+
+	void beat(void*)
+	{
+		++m_iNrOfBeats;
+	}
+
+	Timer m_timer;
+	int m_iNrOfBeats;
+};
+
+
+void simulate(bool bSlack)
+{
+	Sensor arraySensors[NR_OF_SENSORS];
+	Heartbeat arrayHeartbeats[NR_OF_HEARTBEATS];
+
+	uint64 uStartTime = SdkSim::getTime();
+	for (int i = 0; i < NR_OF_SENSORS + NR_OF_HEARTBEATS; ++i)
+	{
+		SdkSim::runUntil(uStartTime + arrayStartOffsetsUs[i]);
+		if (i < NR_OF_SENSORS)
+		{
+			arraySensors[i].start(arraySensorPeriodsMs[i], bSlack);
+		}
+		else
+		{
+			arrayHeartbeats[i - NR_OF_SENSORS].start(arrayHeartbeatPeriodsMs[i - NR_OF_SENSORS], bSlack);
+		}
+	}
+	uint32 uNrOfWakeUps = SdkSim::getNrOfTimerCallbacks();
+	SdkSim::runUntil(uStartTime + DURATION_US);
+	uNrOfWakeUps = SdkSim::getNrOfTimerCallbacks() - uNrOfWakeUps;
+
+	int iNrOfExpiries = 0;
+	uint32 uMaxConversionJitterUs = 0;
+	for (int i = 0; i < NR_OF_SENSORS; ++i)
+	{
+		arraySensors[i].m_period.stop();
+		arraySensors[i].m_conversion.stop();
+		iNrOfExpiries += 2 * arraySensors[i].m_iNrOfReadings;
+		if (arraySensors[i].m_uMaxConversionJitterUs > uMaxConversionJitterUs)
+		{
+			uMaxConversionJitterUs = arraySensors[i].m_uMaxConversionJitterUs;
+		}
+	}
+	for (int i = 0; i < NR_OF_HEARTBEATS; ++i)
+	{
+		arrayHeartbeats[i].m_timer.stop();
+		iNrOfExpiries += arrayHeartbeats[i].m_iNrOfBeats;
+	}
+
+	printf("%s, %s: %d expiries, %u wake ups, conversions up to %u us late\n", TIMER_WHEEL ? "TIMER_WHEEL" : "own os_timers",
+	       bSlack ? "with slack" : "without slack", iNrOfExpiries, uNrOfWakeUps, uMaxConversionJitterUs);
+}
+
+} // namespace
+
+
+int main()
+{
+	simulate(false);
+	simulate(true);
+	return 0;
+}
@@ -0,0 +1,52 @@
+/* 1000 running timers, one of them is restarted for each received message (like a timeout of the connection of a node). The simulated
+   os_timers are kept in a sorted list, like in the SDK, so with TIMER_WHEEL=0 a restart costs O(number of armed timers); the Makefile
+   builds it for both backends.
+*/
+
+#include "Bench.h"
+#include "SdkSim.h"
+#include "Timer.h"
+
+using namespace Esp8266Base;
+
+namespace
+{
+
+const int NR_OF_TIMERS = 1000;
+const int TIMEOUT_MS = 5000;
+const long NR_OF_MESSAGES = 200000;
+const uint64 MESSAGE_INTERVAL_US = 1000;
+
+Timer g_arrayTimers[NR_OF_TIMERS];
+
+} // namespace
+
+
+int main()
+{
+	for (int i = 0; i < NR_OF_TIMERS; ++i)
+	{
+		g_arrayTimers[i].start(TIMEOUT_MS + i);
+	}
+
+	// only the restarts, the simulated time stands still
+	Stopwatch stopwatch;
+	for (long i = 0; i < NR_OF_MESSAGES; ++i)
+	{
+		g_arrayTimers[(i * 7) % NR_OF_TIMERS].start(TIMEOUT_MS);
+	}
+	double dNsPerRestart = stopwatch.getNsPerIteration(NR_OF_MESSAGES);
+
+	// one message per millisecond: the restart and the processing of the timers (the wheel wakes up for its ticks)
+	stopwatch.start();
+	for (long i = 0; i < NR_OF_MESSAGES; ++i)
+	{
+		g_arrayTimers[(i * 7) % NR_OF_TIMERS].start(TIMEOUT_MS);
+		SdkSim::runUntil(SdkSim::getTime() + MESSAGE_INTERVAL_US);
+	}
+	double dNsPerMessage = stopwatch.getNsPerIteration(NR_OF_MESSAGES);
+
+	printf("%s, %d timers: restart %.1f ns, restart and timer processing per message %.1f ns, %d armed os_timers\n",
+	       TIMER_WHEEL ? "TIMER_WHEEL" : "own os_timers", NR_OF_TIMERS, dNsPerRestart, dNsPerMessage, SdkSim::getNrOfArmedTimers());
+	return 0;
+}
@@ -0,0 +1,77 @@
+/* A typical firmware: 5 signals with 3 direct connections each (15 connections), after a startup phase, which used 90 entries of the
+   connection table and removed most of them again. The compaction keeps the 15 live entries at the beginning of the table, so emit(),
+   connect() and disconnect() touch only those.
+*/
+
+#include "Bench.h"
+#include "SdkSim.h"
+#include "Signal.h"
+
+using namespace Esp8266Base;
+
+namespace
+{
+
+const int NR_OF_SIGNALS = 5;
+const int NR_OF_CONNECTIONS_PER_SIGNAL = 3;
+const int NR_OF_STARTUP_CONNECTIONS = 90;
+const long NR_OF_ITERATIONS = 1000000;
+
+class Receiver
+{
+public:
+	Receiver() : m_iNrOfCalls(0) {}
+
+	void slot(void*)
+	{
+		++m_iNrOfCalls;
+	}
+
+	int m_iNrOfCalls;
+};
+
+Signal g_arraySignals[NR_OF_SIGNALS];
+Signal g_startupSignal;
+Receiver g_receiver;
+
+} // namespace
+
+
+int main()
+{
+	// the startup phase: the connections of the application are made between temporary ones
+	static SignalBase::ConnectionHandle arrayStartupHandles[NR_OF_STARTUP_CONNECTIONS];
+	int iNrOfStartupConnections = 0;
+	for (int i = 0; i < NR_OF_SIGNALS * NR_OF_CONNECTIONS_PER_SIGNAL; ++i)
+	{
+		for (int j = 0; j < NR_OF_STARTUP_CONNECTIONS / (NR_OF_SIGNALS * NR_OF_CONNECTIONS_PER_SIGNAL) - 1; ++j)
+		{
+			arrayStartupHandles[iNrOfStartupConnections++] = g_startupSignal.connect(&g_receiver, &Receiver::slot, SignalBase::DirectConnection);
+		}
+		g_arraySignals[i % NR_OF_SIGNALS].connect(&g_receiver, &Receiver::slot, SignalBase::DirectConnection);
+	}
+	for (int i = 0; i < iNrOfStartupConnections; ++i)
+	{
+		g_startupSignal.disconnect(arrayStartupHandles[i]);
+	}
+
+	Stopwatch stopwatch;
+	for (long i = 0; i < NR_OF_ITERATIONS; ++i)
+	{
+		g_arraySignals[i % NR_OF_SIGNALS].emit(NULL);
+	}
+	double dNsPerEmit = stopwatch.getNsPerIteration(NR_OF_ITERATIONS);
+
+	stopwatch.start();
+	for (long i = 0; i < NR_OF_ITERATIONS; ++i)
+	{
+		Signal& signal = g_arraySignals[i % NR_OF_SIGNALS];
+		signal.disconnect(signal.connect(&g_receiver, &Receiver::slot, SignalBase::DirectConnection));
+	}
+	double dNsPerConnect = stopwatch.getNsPerIteration(NR_OF_ITERATIONS);
+
+	printf("%d connections (high-water mark %d): emit() with %d direct slots %.1f ns, connect() + disconnect(handle) %.1f ns\n",
+	       SignalBase::getNrOfConnections(), SignalBase::getConnectionHighWaterMark(), NR_OF_CONNECTIONS_PER_SIGNAL, dNsPerEmit,
+	       dNsPerConnect);
+	return (g_receiver.m_iNrOfCalls == NR_OF_ITERATIONS * NR_OF_CONNECTIONS_PER_SIGNAL) ? 0 : 1;
+}
@@ -12,6 +12,13 @@ extern "C" {
 
 using namespace Esp8266Base;
 
+
+const SignalBase::StaticConnection EspNowUartGateway::s_connectionsStillAlive[] ICACHE_RODATA_ATTR =
+{
+	{&Signal::staticSlot<EspNowUartGateway, &EspNowUartGateway::sendImStillAlive>, SignalBase::DirectConnection, SignalBase::LowPriority},
+	{NULL, SignalBase::DirectConnection, SignalBase::LowPriority}
+};
+
 EspNowUartGateway& ICACHE_FLASH_ATTR EspNowUartGateway::getInstance()
 {
 	// create and return the one instance of the class
@@ -22,8 +29,8 @@ EspNowUartGateway& ICACHE_FLASH_ATTR EspNowUartGateway::getInstance()
 
 ICACHE_FLASH_ATTR EspNowUartGateway::EspNowUartGateway()
 {
-	m_timerStillAlive.timeOut.connect(this, &EspNowUartGateway::sendImStillAlive, Signal::DirectConnection);
-	m_timerStillAlive.start(IM_STILL_ALIVE_TIMEOUT*1000);
+	m_timerStillAlive.timeOut.connectStatic(s_connectionsStillAlive, this);
+	m_timerStillAlive.startPeriodic(IM_STILL_ALIVE_TIMEOUT*1000);
 }
 
 
@@ -37,8 +44,6 @@ void ICACHE_FLASH_ATTR EspNowUartGateway::toUart1(const char* msg)
 void ICACHE_FLASH_ATTR EspNowUartGateway::sendImStillAlive(void*)
 {
 	toUart1(IM_STILL_ALIVE_TEXT);
-
-	m_timerStillAlive.start(IM_STILL_ALIVE_TIMEOUT*1000);
 }
 
 
@@ -62,5 +67,5 @@ void ICACHE_FLASH_ATTR EspNowUartGateway::EspNow2uart1(void* pEspNowMsg)
 		}
 	}
 
-	m_timerStillAlive.start(IM_STILL_ALIVE_TIMEOUT*1000);
+	m_timerStillAlive.startPeriodic(IM_STILL_ALIVE_TIMEOUT*1000);
 }
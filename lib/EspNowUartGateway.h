@@ -69,6 +69,9 @@ private:
 
 	// Measure time since the last ESP-now message
 	Timer m_timerStillAlive;
+
+	// Connections of the signals of the members (stored in flash)
+	static const SignalBase::StaticConnection s_connectionsStillAlive[];
     
 
 	/* Writes the string "Im still alive" to UART1.
@@ -2,6 +2,11 @@
 /* *************     Configuration settings                ****************** */
 /* ************************************************************************** */
 
+// the settings with #ifndef can be overridden in user_config.h
+extern "C" {
+  #include <user_config.h>
+}
+
 #define ENABLE_DEBUG
 
 #define ESP_NOW_WIFI_CHANNEL 1
@@ -12,6 +17,18 @@
 */
 unsigned char ESP_NOW_GATEWAY_MAC[] = {0x06, 0x00, 0x00, 0x00, 0x00, 0x00};
 
+/* Number of ESP-now messages, which can be allocated at the same time (received, but not yet processed by all slots)
+*/
+#ifndef NR_OF_ESP_NOW_MESSAGES
+#define NR_OF_ESP_NOW_MESSAGES 4
+#endif
+
+/* Number of UDP messages, which can be allocated at the same time (received, but not yet processed by all slots)
+*/
+#ifndef NR_OF_UDP_MESSAGES
+#define NR_OF_UDP_MESSAGES 2
+#endif
+
 /* *************     End configuration settings           ******************* */
 
 
@@ -29,6 +46,10 @@ extern "C" {
 
 using namespace Esp8266Base;
 
+MemoryPool<sizeof(EspWifi::EspNowMessage), NR_OF_ESP_NOW_MESSAGES> g_poolEspNowMessages;
+MemoryPool<sizeof(EspWifi::UdpMessage), NR_OF_UDP_MESSAGES> g_poolUdpMessages;
+
+
 ICACHE_FLASH_ATTR EspWifi::EspNowMessage::EspNowMessage(uint8_t *mac, char *data)
 {
 	memcpy(m_mac, mac, 6);
@@ -48,6 +69,29 @@ const char* ICACHE_FLASH_ATTR EspWifi::EspNowMessage::data() const
 }
 
 
+void* ICACHE_FLASH_ATTR EspWifi::EspNowMessage::operator new(size_t size) throw()
+{
+	void* p = g_poolEspNowMessages.allocate();
+	if (NULL == p)
+	{
+		printError("ERROR: EspNowMessage::operator new() failed. NR_OF_ESP_NOW_MESSAGES too small?\n");
+	}
+	return p;
+}
+
+
+void ICACHE_FLASH_ATTR EspWifi::EspNowMessage::operator delete(void* p)
+{
+	g_poolEspNowMessages.release(p);
+}
+
+
+const MemoryPoolBase& ICACHE_FLASH_ATTR EspWifi::EspNowMessage::getMemoryPool()
+{
+	return g_poolEspNowMessages;
+}
+
+
 
 ICACHE_FLASH_ATTR EspWifi::UdpMessage::UdpMessage(char *data)
 {
@@ -61,6 +105,29 @@ const char* ICACHE_FLASH_ATTR EspWifi::UdpMessage::data() const
 }
 
 
+void* ICACHE_FLASH_ATTR EspWifi::UdpMessage::operator new(size_t size) throw()
+{
+	void* p = g_poolUdpMessages.allocate();
+	if (NULL == p)
+	{
+		printError("ERROR: UdpMessage::operator new() failed. NR_OF_UDP_MESSAGES too small?\n");
+	}
+	return p;
+}
+
+
+void ICACHE_FLASH_ATTR EspWifi::UdpMessage::operator delete(void* p)
+{
+	g_poolUdpMessages.release(p);
+}
+
+
+const MemoryPoolBase& ICACHE_FLASH_ATTR EspWifi::UdpMessage::getMemoryPool()
+{
+	return g_poolUdpMessages;
+}
+
+
 
 EspWifi& EspWifi::getInstance(Mode nMode /*= Default */)
 {
@@ -79,6 +146,7 @@ EspWifi& EspWifi::getInstance(Mode nMode /*= Default */)
 void ICACHE_FLASH_ATTR espNowSendCallback(uint8_t *mac_addr, uint8_t status)
 {
   debug(">>> espNowSendCallback("MACSTR",%d)\n", MAC2STR(mac_addr), status);
+  Trace::record(Trace::EspNowSent, NULL, status);
 
   if (0 == status)
   {
@@ -100,6 +168,7 @@ void ICACHE_FLASH_ATTR espNowSendCallback(uint8_t *mac_addr, uint8_t status)
 void ICACHE_FLASH_ATTR espNowRecvCallback(uint8_t *mac, uint8_t *data, uint8_t len)
 {
   debug(">>> espNowRecvCallback("MACSTR", %s, %d)\n", MAC2STR(mac), data, len);
+  Trace::record(Trace::EspNowReceived, data, len);
 
   EspWifi::getInstance().espNowMessageReceived.emit(new EspWifi::EspNowMessage(mac, (char*)data));
 
@@ -7,6 +7,7 @@ extern "C" {
 }
 
 #include "Signal.h"
+#include "MemoryPool.h"
 
 namespace Esp8266Base
 {
@@ -38,6 +39,9 @@ public:
 
 	/*! \class EspNowMessage
 	    \brief Stores the content(payload) and the sender(MAC address) of a received ESP-now message. It only works for ASCII string messages
+
+		The messages are allocated from a fixed-block memory pool (see NR_OF_ESP_NOW_MESSAGES), and not from the heap.
+		If the pool is exhausted, then new returns NULL.
 	*/
 	class EspNowMessage
 	{
@@ -47,6 +51,18 @@ public:
 		*/
 		ICACHE_FLASH_ATTR EspNowMessage(uint8_t *mac, char *data);
 
+		/*! Allocates the message from the memory pool of the ESP-now messages
+		*/
+		static void* ICACHE_FLASH_ATTR operator new(size_t size) throw();
+
+		/*! Returns the message to the memory pool of the ESP-now messages
+		*/
+		static void ICACHE_FLASH_ATTR operator delete(void* p);
+
+		/*! Returns the memory pool of the ESP-now messages (e.g. to read its statistics)
+		*/
+		static const MemoryPoolBase& ICACHE_FLASH_ATTR getMemoryPool();
+
 		/*! Returns the MAC address of the sender
 		*/
 		const uint8_t* ICACHE_FLASH_ATTR from() const;
@@ -64,6 +80,8 @@ public:
 		\brief Stores the content(payload) of a received UDP message.
 
 		It only works for ASCII string messages, and the maximal size for the message is 255 bytes.
+		The messages are allocated from a fixed-block memory pool (see NR_OF_UDP_MESSAGES), and not from the heap.
+		If the pool is exhausted, then new returns NULL.
 	*/
 	class UdpMessage
 	{
@@ -73,6 +91,18 @@ public:
 		*/
 		ICACHE_FLASH_ATTR UdpMessage(char *data);
 
+		/*! Allocates the message from the memory pool of the UDP messages
+		*/
+		static void* ICACHE_FLASH_ATTR operator new(size_t size) throw();
+
+		/*! Returns the message to the memory pool of the UDP messages
+		*/
+		static void ICACHE_FLASH_ATTR operator delete(void* p);
+
+		/*! Returns the memory pool of the UDP messages (e.g. to read its statistics)
+		*/
+		static const MemoryPoolBase& ICACHE_FLASH_ATTR getMemoryPool();
+
 		/*! Returns the content of the message
 		*/
 		const char* ICACHE_FLASH_ATTR data() const;
@@ -0,0 +1,87 @@
+#ifndef LOCK_FREE_QUEUE_H_INCLUDED
+#define LOCK_FREE_QUEUE_H_INCLUDED
+
+namespace Esp8266Base
+{
+
+/*! \class LockFreeQueue
+    \brief Fixed size single-producer/single-consumer queue without locks
+
+   The producer (e.g. an interrupt handler) calls only push(), the consumer (e.g. a task) calls only pop().
+   In this case none of them has to disable interrupts, and push() has a constant, short runtime.
+   The class doesn't depend on the Espressif SDK, so it can be used (and tested) on a host computer too, where a
+   signal handler or a second thread plays the role of the interrupt handler.
+   Restrictions:
+   - SIZE must be a power of two, and the queue can store SIZE-1 elements
+   - T must be copyable with operator=
+   .
+ */
+template <class T, unsigned int SIZE>
+class LockFreeQueue
+{
+public:
+
+	LockFreeQueue() : m_uHead(0), m_uTail(0) {}
+
+	/*! Appends an element to the end of the queue. Returns false, if the queue is full.
+	    Only the producer is allowed to call it.
+	*/
+	bool push(const T& element)
+	{
+		bool bRet = false;
+		unsigned int uHead = m_uHead;
+		unsigned int uNextHead = (uHead + 1) & (SIZE - 1);
+		if (uNextHead != m_uTail)
+		{
+			m_arrayElements[uHead] = element;
+
+			// the element must be stored, before the consumer sees the new head
+			__sync_synchronize();
+			m_uHead = uNextHead;
+			bRet = true;
+		}
+		return bRet;
+	}
+
+	/*! Removes the first element of the queue and copies it to element. Returns false, if the queue is empty.
+	    Only the consumer is allowed to call it.
+	*/
+	bool pop(T& element)
+	{
+		bool bRet = false;
+		unsigned int uTail = m_uTail;
+		if (uTail != m_uHead)
+		{
+			// read the element only after the head has been read
+			__sync_synchronize();
+			element = m_arrayElements[uTail];
+
+			// the element must be read, before the producer can overwrite it
+			__sync_synchronize();
+			m_uTail = (uTail + 1) & (SIZE - 1);
+			bRet = true;
+		}
+		return bRet;
+	}
+
+	/*! Returns true, if there is no element in the queue.
+	*/
+	bool isEmpty() const { return m_uHead == m_uTail; }
+
+private:
+
+	// SIZE must be a power of two (the array size is negative otherwise, and the compilation fails)
+	typedef char SizeMustBePowerOfTwo[(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0) ? 1 : -1];
+
+	T m_arrayElements[SIZE];
+
+	// index of the next free element, written only by the producer
+	volatile unsigned int m_uHead;
+
+	// index of the first stored element, written only by the consumer
+	volatile unsigned int m_uTail;
+};
+
+}
+
+#endif
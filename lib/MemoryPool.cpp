@@ -0,0 +1,79 @@
+#include "MemoryPool.h"
+
+using namespace Esp8266Base;
+
+MemoryPoolBase* MemoryPoolBase::s_pFirstPool = NULL;
+
+
+void* ICACHE_FLASH_ATTR MemoryPoolBase::allocateBlock(char* pArena, unsigned int uBlockSize, unsigned int uNrOfBlocks)
+{
+	if (!m_bRegistered)
+	{
+		m_pArena = pArena;
+		m_uBlockSize = uBlockSize;
+		m_uNrOfBlocks = uNrOfBlocks;
+		m_pNextPool = s_pFirstPool;
+		s_pFirstPool = this;
+		m_bRegistered = true;
+	}
+
+	void* pBlock = NULL;
+	if (NULL != m_pFirstFreeBlock)
+	{
+		pBlock = m_pFirstFreeBlock;
+		m_pFirstFreeBlock = m_pFirstFreeBlock->pNext;
+	}
+	else if (m_uNrOfInitializedBlocks < m_uNrOfBlocks)
+	{
+		pBlock = m_pArena + m_uNrOfInitializedBlocks * m_uBlockSize;
+		++m_uNrOfInitializedBlocks;
+	}
+
+	if (NULL != pBlock)
+	{
+		++m_uNrOfUsedBlocks;
+		if (m_uNrOfUsedBlocks > m_uHighWaterMark)
+		{
+			m_uHighWaterMark = m_uNrOfUsedBlocks;
+		}
+	}
+	else
+	{
+		++m_uNrOfAllocationFailures;
+	}
+
+	return pBlock;
+}
+
+
+bool ICACHE_FLASH_ATTR MemoryPoolBase::owns(const void* pBlock) const
+{
+	const char* p = static_cast<const char*>(pBlock);
+	return m_bRegistered && m_pArena <= p && p < m_pArena + m_uNrOfBlocks * m_uBlockSize;
+}
+
+
+bool ICACHE_FLASH_ATTR MemoryPoolBase::release(void* pBlock)
+{
+	bool bRet = false;
+	if (owns(pBlock))
+	{
+		FreeBlock* pFreeBlock = static_cast<FreeBlock*>(pBlock);
+		pFreeBlock->pNext = m_pFirstFreeBlock;
+		m_pFirstFreeBlock = pFreeBlock;
+		--m_uNrOfUsedBlocks;
+		bRet = true;
+	}
+	return bRet;
+}
+
+
+bool ICACHE_FLASH_ATTR MemoryPoolBase::releaseToOwnerPool(void* pBlock)
+{
+	bool bRet = false;
+	for (MemoryPoolBase* pPool = s_pFirstPool; NULL != pPool && !bRet; pPool = pPool->m_pNextPool)
+	{
+		bRet = pPool->release(pBlock);
+	}
+	return bRet;
+}
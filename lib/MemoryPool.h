@@ -0,0 +1,116 @@
+#ifndef MEMORY_POOL_H_INCLUDED
+#define MEMORY_POOL_H_INCLUDED
+
+extern "C"
+{
+	#include "c_types.h"
+}
+
+namespace Esp8266Base
+{
+
+/*! \class MemoryPoolBase
+    \brief Common part of all MemoryPool instances: the free list and the statistics
+
+   The blocks are never initialized by a constructor: an unused block is taken from the arena at the first allocation,
+   and released blocks are stored in a free list. So a pool is usable without running global constructors, and both
+   allocation and release are O(1).
+   Each pool registers itself at its first allocation, so that releaseToOwnerPool() can find the pool of any block.
+ */
+class MemoryPoolBase
+{
+public:
+
+	/*! Returns a block to the pool. Returns false (and doesn't do anything), if pBlock wasn't allocated from this pool.
+	*/
+	bool ICACHE_FLASH_ATTR release(void* pBlock);
+
+	/*! Returns true, if pBlock has been allocated from this pool.
+	*/
+	bool ICACHE_FLASH_ATTR owns(const void* pBlock) const;
+
+	/*! Returns the number of currently allocated blocks.
+	*/
+	unsigned int ICACHE_FLASH_ATTR getNrOfUsedBlocks() const { return m_uNrOfUsedBlocks; }
+
+	/*! Returns the highest number of simultaneously allocated blocks since startup.
+	*/
+	unsigned int ICACHE_FLASH_ATTR getHighWaterMark() const { return m_uHighWaterMark; }
+
+	/*! Returns the number of allocations, which failed because all blocks were in use.
+	*/
+	unsigned int ICACHE_FLASH_ATTR getNrOfAllocationFailures() const { return m_uNrOfAllocationFailures; }
+
+	/*! Returns pBlock to the pool, which it has been allocated from. Returns false, if pBlock doesn't belong to any pool.
+	*/
+	static bool ICACHE_FLASH_ATTR releaseToOwnerPool(void* pBlock);
+
+protected:
+
+	// Allocates a block of the arena. Returns NULL, if all blocks are in use.
+	void* ICACHE_FLASH_ATTR allocateBlock(char* pArena, unsigned int uBlockSize, unsigned int uNrOfBlocks);
+
+private:
+
+	struct FreeBlock
+	{
+		FreeBlock* pNext;
+	};
+
+	// list of the released blocks
+	FreeBlock* m_pFirstFreeBlock;
+
+	// the arena and its geometry, known after the first allocation
+	char* m_pArena;
+	unsigned int m_uBlockSize;
+	unsigned int m_uNrOfBlocks;
+
+	// number of blocks taken from the arena (the blocks after them have never been allocated)
+	unsigned int m_uNrOfInitializedBlocks;
+
+	unsigned int m_uNrOfUsedBlocks;
+	unsigned int m_uHighWaterMark;
+	unsigned int m_uNrOfAllocationFailures;
+
+	// list of the pools, which have been used already
+	bool m_bRegistered;
+	MemoryPoolBase* m_pNextPool;
+	static MemoryPoolBase* s_pFirstPool;
+};
+
+
+/*! \class MemoryPool
+    \brief Fixed-block memory pool in a static arena
+
+   The pool has NR_OF_BLOCKS blocks of BLOCK_SIZE bytes. The memory is part of the object, so a global MemoryPool
+   is placed in .bss, and doesn't use the heap at all. Allocation and release are O(1), and the pool can't fragment.
+   Typical usage is a class-level operator new / operator delete of classes, which are frequently allocated.
+ */
+template <unsigned int BLOCK_SIZE, unsigned int NR_OF_BLOCKS>
+class MemoryPool : public MemoryPoolBase
+{
+public:
+
+	/*! Allocates a block. Returns NULL, if all blocks are in use.
+	*/
+	void* allocate() { return allocateBlock(m_arena.buffer, ALIGNED_BLOCK_SIZE, NR_OF_BLOCKS); }
+
+	/*! Returns the number of blocks of the pool.
+	*/
+	unsigned int getNrOfBlocks() const { return NR_OF_BLOCKS; }
+
+private:
+
+	// each block must be able to store the pointer of the free list, and must be aligned to 4 bytes
+	enum { ALIGNED_BLOCK_SIZE = ((BLOCK_SIZE < sizeof(void*) ? sizeof(void*) : BLOCK_SIZE) + 3) & ~3 };
+
+	union
+	{
+		uint32 uAlignment;
+		char buffer[ALIGNED_BLOCK_SIZE * NR_OF_BLOCKS];
+	} m_arena;
+};
+
+}
+
+#endif
@@ -18,176 +18,1467 @@ extern "C" {
 }
 
 #include "debug.h"
+#include "LockFreeQueue.h"
+#include "MemoryPool.h"
+
+SignalBase::SignalSlotConnection SignalBase::s_listConnections[MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS];
+int SignalBase::s_iNrOfUsedEntries = 0;
+int SignalBase::s_iNrOfConnections = 0;
+int SignalBase::s_iConnectionHighWaterMark = 0;
+SignalBase::HandleSlot SignalBase::s_arrayHandleSlots[MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS];
+int SignalBase::s_iFirstFreeHandleSlot = -1;
+int SignalBase::s_iNrOfInitializedHandleSlots = 0;
+int SignalBase::s_iNrOfListWalks = 0;
+int SignalBase::s_iFirstRemovedEntry = -1;
+SignalBase::StaticConnections SignalBase::s_arrayStaticConnections[MAX_NR_OF_STATIC_CONNECTION_ARRAYS];
+
+
+/* The parameter of an emitted signal is shared by the queued slots, and the last one frees it.
+   Instead of searching the other queued slots for the same parameter, each parameter has a reference counter:
+   emit() holds one reference while it is running, and each queued slot holds one until it has been called.
+*/
+struct SharedParameter
+{
+	SharedParameter() : pParameter(NULL), iRefCount(0) {}
+	void* pParameter;
+	int iRefCount;
+};
+
+// Each queued slot refers to at most one shared parameter, and each emit() in progress holds one, which might not be queued (yet).
+// The emits can be nested, so each level needs an entry.
+#define MAX_NR_OF_SHARED_PARAMETERS (MAX_NR_OF_QUEUED_SIGNALS + MAX_NR_OF_QUEUED_SIGNALS_MEDIUM_PRIORITY + MAX_NR_OF_QUEUED_SIGNALS_HIGH_PRIORITY + \
+                                     MAX_NESTING_OF_EMITS)
+SharedParameter g_arraySharedParameters[MAX_NR_OF_SHARED_PARAMETERS];
+
+
+// Returns the index of a new shared parameter with one reference, or -1 if there is no free entry
+int acquireSharedParameter(void* pParameter)
+{
+	int i = 0;
+	while (i < MAX_NR_OF_SHARED_PARAMETERS && g_arraySharedParameters[i].iRefCount != 0)
+	{
+		++i;
+	}
+
+	if (i < MAX_NR_OF_SHARED_PARAMETERS)
+	{
+		g_arraySharedParameters[i].pParameter = pParameter;
+		g_arraySharedParameters[i].iRefCount = 1;
+	}
+	else
+	{
+		i = -1;
+	}
+	return i;
+}
+
+
+// Frees the parameter of a signal: returns it to its memory pool, or to the heap, if it isn't from a pool
+void freeParameter(void* pParameter)
+{
+	if (!MemoryPoolBase::releaseToOwnerPool(pParameter))
+	{
+		os_free(pParameter);
+	}
+}
+
+
+// Drops one reference of the shared parameter, and frees the parameter if it was the last reference
+void releaseSharedParameter(int i)
+{
+	--g_arraySharedParameters[i].iRefCount;
+	if (0 == g_arraySharedParameters[i].iRefCount)
+	{
+		freeParameter(g_arraySharedParameters[i].pParameter);
+		g_arraySharedParameters[i].pParameter = NULL;
+	}
+}
+
+
+// Starts the task, which is processing the queued signals with the priority (if it hasn't been started yet)
+void startInvokeTask(SignalBase::Priority priority);
+
+
+// Start time of the running queued slot (system_get_time()), and whether it has to be called again (see SignalBase::callAgain()).
+// The flag is cleared while a direct slot runs (see SignalBase::invokeSlotDirect()), because it isn't the queued slot.
+uint32 g_uSlotStartTime = 0;
+bool g_bQueuedSlotIsRunning = false;
+bool g_bCallAgain = false;
+
+
+#if SIGNAL_STATISTICS
+uint32 g_arrayLatencyHistogram[SignalBase::NR_OF_HISTOGRAM_BUCKETS];
+uint32 g_arrayRuntimeHistogram[SignalBase::NR_OF_HISTOGRAM_BUCKETS];
+uint32 g_uMaxRuntime = 0;
+const SignalBase* g_pSlowestSignal = NULL;
+
+
+// Increments the bucket of the histogram, which belongs to the duration (in microseconds)
+void addToHistogram(uint32* pHistogram, uint32 uDuration)
+{
+	int iBucket = 0;
+	uint32 uLimit = 16;
+	while (iBucket < SignalBase::NR_OF_HISTOGRAM_BUCKETS - 1 && uDuration >= uLimit)
+	{
+		uLimit <<= 2;
+		++iBucket;
+	}
+	++pHistogram[iBucket];
+}
+
+
+// Stores the runtime of a slot of the signal (the signal might have been deleted by the slot, it is used only for printing)
+void addRuntime(const SignalBase* pSignal, uint32 uRuntime)
+{
+	addToHistogram(g_arrayRuntimeHistogram, uRuntime);
+	if (uRuntime > g_uMaxRuntime)
+	{
+		g_uMaxRuntime = uRuntime;
+		g_pSlowestSignal = pSignal;
+	}
+}
+#endif
+
+// The queued call iInvoke of the priority won't update its connection anymore (because the connection has been removed)
+void detachPendingInvoke(SignalBase::Priority priority, int iInvoke);
+
+// The queued call iInvoke of the priority updates piPendingInvoke (because its connection has been moved)
+void movePendingInvoke(SignalBase::Priority priority, int iInvoke, int* piPendingInvoke);
+
+// The queued fan-out calls of the signal won't call any slots, they only release their parameter
+void cancelFanOutInvokes(const SignalBase* pSignal);
+
+// The function of a dropped queued call
+void invokeNothing(const DelegateMemento&, const void*)
+{
+}
+
+
+SignalBase::SignalBase() : m_iNrOfQueuedConnections(0), m_iFirstConnection(-1), m_OverflowPolicy(DropNewest), m_bFanOut(false), m_bStaticConnections(false)
+{
+#if SIGNAL_STATISTICS
+	m_uNrOfEmits = m_uNrOfDirectDeliveries = m_uNrOfQueuedDeliveries = 0;
+#endif
+
+	// the task with low priority processes the signals emitted from interrupt handlers too, so it is always started
+	startInvokeTask(LowPriority);
+}
+
+SignalBase::SignalBase(const char* strSignalName) : m_iNrOfQueuedConnections(0), m_iFirstConnection(-1), m_OverflowPolicy(DropNewest), m_bFanOut(false),
+                                                     m_bStaticConnections(false)
+{
+	debug("%p Signal::Signal(%s)\n", this, strSignalName);
+
+#if SIGNAL_STATISTICS
+	m_uNrOfEmits = m_uNrOfDirectDeliveries = m_uNrOfQueuedDeliveries = 0;
+#endif
+
+	startInvokeTask(LowPriority);
+}
+
+
+SignalBase::~SignalBase()
+{
+	while (-1 != m_iFirstConnection)
+	{
+		removeConnection(m_iFirstConnection);
+	}
+
+	for (int iArray = 0; iArray < MAX_NR_OF_STATIC_CONNECTION_ARRAYS; ++iArray)
+	{
+		if (this == s_arrayStaticConnections[iArray].m_pSignal)
+		{
+			s_arrayStaticConnections[iArray].m_pSignal = NULL;
+		}
+	}
+
+	if (m_bFanOut)
+	{
+		cancelFanOutInvokes(this);
+	}
+}
+
+
+int SignalBase::allocateConnection()
+{
+	int iConnectionIndex = -1;
+	if (s_iNrOfUsedEntries < MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS)
+	{
+		// there are at most as many used handle slots as used entries, so there is a free handle slot too
+		int iHandleSlot = s_iFirstFreeHandleSlot;
+		if (-1 != iHandleSlot)
+		{
+			s_iFirstFreeHandleSlot = s_arrayHandleSlots[iHandleSlot].iConnectionIndex;
+		}
+		else
+		{
+			iHandleSlot = s_iNrOfInitializedHandleSlots;
+			++s_iNrOfInitializedHandleSlots;
+		}
+
+		iConnectionIndex = s_iNrOfUsedEntries;
+		++s_iNrOfUsedEntries;
+		s_arrayHandleSlots[iHandleSlot].iConnectionIndex = iConnectionIndex;
+		s_listConnections[iConnectionIndex].m_iHandleSlot = iHandleSlot;
+
+		++s_iNrOfConnections;
+		if (s_iNrOfConnections > s_iConnectionHighWaterMark)
+		{
+			s_iConnectionHighWaterMark = s_iNrOfConnections;
+		}
+	}
+	return iConnectionIndex;
+}
+
+
+void SignalBase::releaseConnection(int iConnectionIndex)
+{
+	// the handles of the released connection become invalid
+	HandleSlot& handleSlot = s_arrayHandleSlots[s_listConnections[iConnectionIndex].m_iHandleSlot];
+	handleSlot.uGeneration = (handleSlot.uGeneration + 1) & 0x7fff;
+	handleSlot.iConnectionIndex = s_iFirstFreeHandleSlot;
+	s_iFirstFreeHandleSlot = s_listConnections[iConnectionIndex].m_iHandleSlot;
+
+	s_listConnections[iConnectionIndex].m_Signal = 0;
+	--s_iNrOfConnections;
+
+	if (s_iNrOfListWalks > 0)
+	{
+		// the entry is removed from the table, when no connection list is walked anymore
+		s_listConnections[iConnectionIndex].m_iPendingInvoke = s_iFirstRemovedEntry;
+		s_iFirstRemovedEntry = iConnectionIndex;
+	}
+	else
+	{
+		fillEntry(iConnectionIndex);
+	}
+}
+
+
+void SignalBase::fillEntry(int iConnectionIndex)
+{
+	--s_iNrOfUsedEntries;
+	if (iConnectionIndex != s_iNrOfUsedEntries && 0 != s_listConnections[s_iNrOfUsedEntries].m_Signal)
+	{
+		moveConnection(s_iNrOfUsedEntries, iConnectionIndex);
+	}
+}
+
+
+void SignalBase::moveConnection(int iFrom, int iTo)
+{
+	SignalSlotConnection& connection = s_listConnections[iTo];
+	connection = s_listConnections[iFrom];
+	s_listConnections[iFrom].m_Signal = 0;
+	s_arrayHandleSlots[connection.m_iHandleSlot].iConnectionIndex = iTo;
+
+	SignalBase* pSignal = connection.m_Signal;
+	if (iFrom == pSignal->m_iFirstConnection)
+	{
+		pSignal->m_iFirstConnection = iTo;
+	}
+	else
+	{
+		s_listConnections[connection.m_iPrevious].m_iNext = iTo;
+	}
+	if (-1 != connection.m_iNext)
+	{
+		s_listConnections[connection.m_iNext].m_iPrevious = iTo;
+	}
+	else
+	{
+		// the first connection stores the index of the last one
+		s_listConnections[pSignal->m_iFirstConnection].m_iPrevious = iTo;
+	}
+
+	if (-1 != connection.m_iPendingInvoke)
+	{
+		movePendingInvoke(static_cast<Priority>(connection.m_Priority), connection.m_iPendingInvoke, &connection.m_iPendingInvoke);
+	}
+}
+
+
+void SignalBase::beginListWalk()
+{
+	++s_iNrOfListWalks;
+}
+
+
+void SignalBase::endListWalk()
+{
+	--s_iNrOfListWalks;
+	if (0 == s_iNrOfListWalks)
+	{
+		// the last entries are moved into the removed ones, so the used entries are at the beginning of the table again
+		while (-1 != s_iFirstRemovedEntry)
+		{
+			int iRemoved = s_iFirstRemovedEntry;
+			s_iFirstRemovedEntry = s_listConnections[iRemoved].m_iPendingInvoke;
+
+			// the removed entries at the end are dropped (the ones, which are still in the chain, are skipped, when they are taken)
+			while (s_iNrOfUsedEntries > 0 && 0 == s_listConnections[s_iNrOfUsedEntries - 1].m_Signal)
+			{
+				--s_iNrOfUsedEntries;
+			}
+			if (iRemoved < s_iNrOfUsedEntries)
+			{
+				fillEntry(iRemoved);
+			}
+		}
+	}
+}
+
+
+int SignalBase::getNrOfConnections()
+{
+	return s_iNrOfConnections;
+}
+
+
+int SignalBase::getConnectionHighWaterMark()
+{
+	return s_iConnectionHighWaterMark;
+}
+
+
+int SignalBase::connectSlot(const DelegateMemento& slot, ConnectionType connectionType, Priority priority, bool bOnce)
+{
+	int iConnectionIndex = allocateConnection();
+	if (-1 != iConnectionIndex)
+	{
+		s_listConnections[iConnectionIndex].m_Signal = this;
+		s_listConnections[iConnectionIndex].m_Slot = slot;
+		s_listConnections[iConnectionIndex].m_Type = connectionType;
+		s_listConnections[iConnectionIndex].m_Priority = priority;
+		s_listConnections[iConnectionIndex].m_bOnce = bOnce;
+		s_listConnections[iConnectionIndex].m_iPendingInvoke = -1;
+		appendConnection(iConnectionIndex);
+
+		if (DirectConnection != connectionType)
+		{
+			++m_iNrOfQueuedConnections;
+			startInvokeTask(priority);
+		}
+	}
+	ConnectionHandle handle = -1;
+	if (-1 != iConnectionIndex)
+	{
+		int iHandleSlot = s_listConnections[iConnectionIndex].m_iHandleSlot;
+		handle = (s_arrayHandleSlots[iHandleSlot].uGeneration << 16) | iHandleSlot;
+	}
+	return handle;
+}
+
+
+int SignalBase::findConnection(ConnectionHandle handle) const
+{
+	int iConnectionIndex = -1;
+	int iHandleSlot = handle & 0xffff;
+	if (handle >= 0 && iHandleSlot < s_iNrOfInitializedHandleSlots && s_arrayHandleSlots[iHandleSlot].uGeneration == (handle >> 16))
+	{
+		// the handle slot might be free (with an unused generation), so the entry must refer back to it
+		iConnectionIndex = s_arrayHandleSlots[iHandleSlot].iConnectionIndex;
+		if (iConnectionIndex < 0 || iConnectionIndex >= s_iNrOfUsedEntries || s_listConnections[iConnectionIndex].m_Signal != this
+		    || s_listConnections[iConnectionIndex].m_iHandleSlot != iHandleSlot)
+		{
+			iConnectionIndex = -1;
+		}
+	}
+	return iConnectionIndex;
+}
+
+
+bool SignalBase::isConnected(ConnectionHandle handle) const
+{
+	return -1 != findConnection(handle);
+}
+
+
+int SignalBase::disconnect(ConnectionHandle handle)
+{
+	int iNrOfDisconnects = 0;
+	int iConnectionIndex = findConnection(handle);
+	if (-1 != iConnectionIndex)
+	{
+		removeConnection(iConnectionIndex);
+		iNrOfDisconnects = 1;
+	}
+	return iNrOfDisconnects;
+}
+
+
+void SignalBase::appendConnection(int iConnectionIndex)
+{
+	SignalSlotConnection& connection = s_listConnections[iConnectionIndex];
+	connection.m_iNext = -1;
+
+	if (-1 == m_iFirstConnection)
+	{
+		m_iFirstConnection = iConnectionIndex;
+		connection.m_iPrevious = iConnectionIndex;
+	}
+	else
+	{
+		// append to the end of the list (the first connection knows the last one), so that the slots are called in the order of the connections
+		int iLast = s_listConnections[m_iFirstConnection].m_iPrevious;
+		s_listConnections[iLast].m_iNext = iConnectionIndex;
+		connection.m_iPrevious = iLast;
+		s_listConnections[m_iFirstConnection].m_iPrevious = iConnectionIndex;
+	}
+}
+
+
+void SignalBase::removeConnection(int iConnectionIndex)
+{
+	SignalSlotConnection& connection = s_listConnections[iConnectionIndex];
+	if (iConnectionIndex == m_iFirstConnection)
+	{
+		m_iFirstConnection = connection.m_iNext;
+		if (-1 != connection.m_iNext)
+		{
+			// the new first connection takes over the index of the last one
+			s_listConnections[connection.m_iNext].m_iPrevious = connection.m_iPrevious;
+		}
+	}
+	else
+	{
+		s_listConnections[connection.m_iPrevious].m_iNext = connection.m_iNext;
+		if (-1 != connection.m_iNext)
+		{
+			s_listConnections[connection.m_iNext].m_iPrevious = connection.m_iPrevious;
+		}
+		else
+		{
+			s_listConnections[m_iFirstConnection].m_iPrevious = connection.m_iPrevious;
+		}
+	}
+
+	if (DirectConnection != connection.m_Type)
+	{
+		--m_iNrOfQueuedConnections;
+	}
+	if (-1 != connection.m_iPendingInvoke)
+	{
+		// the queued call is still executed, but it must not refer to the removed connection
+		detachPendingInvoke(static_cast<Priority>(connection.m_Priority), connection.m_iPendingInvoke);
+	}
+
+	// m_iNext is left unchanged, so that an emit() in progress can continue with the next connection
+	releaseConnection(iConnectionIndex);
+}
+
+
+int SignalBase::disconnectSlot(const DelegateMemento& slot)
+{
+	int iNrOfDisconnects = 0;
+	beginListWalk();
+	int i = m_iFirstConnection;
+	while (i != -1)
+	{
+		int iNext = s_listConnections[i].m_iNext;
+		if (s_listConnections[i].m_Slot.IsEqual(slot))
+		{
+			removeConnection(i);
+			++iNrOfDisconnects;
+		}
+		i = iNext;
+	}
+	endListWalk();
+	return iNrOfDisconnects;
+}
+
+
+bool SignalBase::connectStatic(const StaticConnection* pConnections, void* pReceiver)
+{
+	int iArray = 0;
+	while (iArray < MAX_NR_OF_STATIC_CONNECTION_ARRAYS && NULL != s_arrayStaticConnections[iArray].m_pSignal)
+	{
+		++iArray;
+	}
+	if (MAX_NR_OF_STATIC_CONNECTION_ARRAYS == iArray)
+	{
+		printError("ERROR: Signal::connectStatic couldn't store the static connections. MAX_NR_OF_STATIC_CONNECTION_ARRAYS too small?\n");
+		return false;
+	}
+
+	s_arrayStaticConnections[iArray].m_pSignal = this;
+	s_arrayStaticConnections[iArray].m_pConnections = pConnections;
+	s_arrayStaticConnections[iArray].m_pReceiver = pReceiver;
+	m_bStaticConnections = true;
+
+	m_iNrOfQueuedConnections += countQueuedStaticConnections(pConnections);
+	for (int i = 0; NULL != pConnections[i].pfnGetSlot; ++i)
+	{
+		if (DirectConnection != pConnections[i].type)
+		{
+			startInvokeTask(pConnections[i].priority);
+		}
+	}
+	return true;
+}
+
+
+bool SignalBase::disconnectStatic(const StaticConnection* pConnections, void* pReceiver)
+{
+	bool bRet = false;
+	m_bStaticConnections = false;
+	for (int iArray = 0; iArray < MAX_NR_OF_STATIC_CONNECTION_ARRAYS; ++iArray)
+	{
+		StaticConnections& connections = s_arrayStaticConnections[iArray];
+		if (this == connections.m_pSignal && pConnections == connections.m_pConnections && pReceiver == connections.m_pReceiver && !bRet)
+		{
+			m_iNrOfQueuedConnections -= countQueuedStaticConnections(pConnections);
+			connections.m_pSignal = NULL;
+			bRet = true;
+		}
+		else if (this == connections.m_pSignal)
+		{
+			m_bStaticConnections = true;
+		}
+	}
+	return bRet;
+}
+
+
+void SignalBase::setFanOut(bool bFanOut)
+{
+	if (m_bFanOut && !bFanOut)
+	{
+		cancelFanOutInvokes(this);
+	}
+	m_bFanOut = bFanOut;
+}
+
+
+int SignalBase::countQueuedStaticConnections(const StaticConnection* pConnections)
+{
+	int iCount = 0;
+	for (int i = 0; NULL != pConnections[i].pfnGetSlot; ++i)
+	{
+		if (DirectConnection != pConnections[i].type)
+		{
+			++iCount;
+		}
+	}
+	return iCount;
+}
+
+
+int SignalBase::dispatch(const void* pPayload, unsigned int uPayloadSize, InvokeFunction pfnInvoke, InvokeFunction pfnInvokeQueued, ReleaseFunction pfnRelease)
+{
+	debug("%p >>> emit()\n", this);
+
+#if SIGNAL_STATISTICS
+	++m_uNrOfEmits;
+#endif
+
+	int iNrOfQueuedSlots = 0;
+
+	// the slots might remove connections, but the entries aren't moved until the end of the emit
+	beginListWalk();
+
+	// in fan-out mode the QueuedConnections aren't queued one by one, only the priorities are collected
+	bool arrayFanOut[HighPriority + 1] = { false, false, false };
+
+	if (m_bStaticConnections)
+	{
+		iNrOfQueuedSlots += dispatchStatic(arrayFanOut, pfnInvoke, pfnInvokeQueued, pfnRelease, pPayload, uPayloadSize);
+	}
+	int i = m_iFirstConnection;
+	while (i != -1)
+	{
+		// a slot might have removed this connection: a removed entry keeps its m_iNext until the end of the walk
+		if (s_listConnections[i].m_Signal != this)
+		{
+			i = s_listConnections[i].m_iNext;
+			continue;
+		}
+
+		int iNext = s_listConnections[i].m_iNext;
+		if (s_listConnections[i].m_bOnce)
+		{
+			// the connection is removed before its slot is called or queued, so a slot, which emits the signal again, can't call it twice
+			SignalSlotConnection connection = s_listConnections[i];
+			removeConnection(i);
+			if (invokeDetachedSlot(connection, pfnInvoke, pfnInvokeQueued, pfnRelease, pPayload, uPayloadSize))
+			{
+				++iNrOfQueuedSlots;
+			}
+
+			// the removed entry still points to the next connection, which the slot might have removed too (then it is skipped)
+			iNext = s_listConnections[i].m_iNext;
+		}
+		else if (s_listConnections[i].m_Type == DirectConnection)
+		{
+			// call the slot directly
+			invokeSlotDirect(s_listConnections[i].m_Slot, pfnInvoke, pPayload);
+
+			// the slot might have modified the connections of this signal (or removed this one)
+			iNext = s_listConnections[i].m_iNext;
+		}
+		else if (NULL != pfnInvokeQueued && m_bFanOut && QueuedConnection == s_listConnections[i].m_Type)
+		{
+			arrayFanOut[s_listConnections[i].m_Priority] = true;
+		}
+		else if (NULL == pfnInvokeQueued)
+		{
+			invokeSlotUnqueued(s_listConnections[i], pfnInvoke, pPayload);
+
+			// a slot called inline might have modified the connections of this signal (or removed this one)
+			iNext = s_listConnections[i].m_iNext;
+		}
+		else
+		{
+			// the slot will be invoked later
+			if (invokeSlotQueued(s_listConnections[i], pfnInvokeQueued, pfnRelease, pPayload, uPayloadSize))
+			{
+				++iNrOfQueuedSlots;
+			}
+			else if (RunInline == m_OverflowPolicy)
+			{
+				// the queue is full: the slot is called now (the parameter is still owned by emit())
+				invokeSlotDirect(s_listConnections[i].m_Slot, pfnInvoke, pPayload);
+
+				// the slot might have modified the connections of this signal (or removed this one)
+				iNext = s_listConnections[i].m_iNext;
+			}
+		}
+		i = iNext;
+	}
+
+	for (int iPriority = LowPriority; iPriority <= HighPriority; ++iPriority)
+	{
+		if (arrayFanOut[iPriority])
+		{
+			// one queue entry for all QueuedConnections of the priority: the task calls the slots with pfnInvoke, and releases the payload once
+			SignalSlotConnection connection;
+			connection.m_Signal = this;
+			connection.m_Type = QueuedConnection;
+			connection.m_Priority = static_cast<Priority>(iPriority);
+			connection.m_iPendingInvoke = -1;
+			if (invokeSlotQueued(connection, pfnInvoke, pfnRelease, pPayload, uPayloadSize, true))
+			{
+				++iNrOfQueuedSlots;
+			}
+			else if (RunInline == m_OverflowPolicy)
+			{
+				invokeFanOut(this, static_cast<Priority>(iPriority), pfnInvoke, pPayload);
+			}
+		}
+	}
+
+	endListWalk();
+
+	debug("%p <<< emit()\n", this);
+
+	return iNrOfQueuedSlots;
+}
+
+
+int SignalBase::dispatchStatic(bool* pFanOut, InvokeFunction pfnInvoke, InvokeFunction pfnInvokeQueued, ReleaseFunction pfnRelease,
+                               const void* pPayload, unsigned int uPayloadSize)
+{
+	int iNrOfQueuedSlots = 0;
+	for (int iArray = 0; iArray < MAX_NR_OF_STATIC_CONNECTION_ARRAYS; ++iArray)
+	{
+		if (this != s_arrayStaticConnections[iArray].m_pSignal)
+		{
+			continue;
+		}
+
+		// the static connections are read from flash member by member (32 bit access), and don't need any lookup
+		const StaticConnection* pConnections = s_arrayStaticConnections[iArray].m_pConnections;
+		void* pReceiver = s_arrayStaticConnections[iArray].m_pReceiver;
+		for (int i = 0; NULL != pConnections[i].pfnGetSlot; ++i)
+		{
+			SignalSlotConnection connection;
+			connection.m_Signal = this;
+			connection.m_Type = pConnections[i].type;
+			connection.m_Priority = pConnections[i].priority;
+			pConnections[i].pfnGetSlot(pReceiver, connection.m_Slot);
+			if (NULL != pfnInvokeQueued && m_bFanOut && DirectConnection != connection.m_Type)
+			{
+				pFanOut[connection.m_Priority] = true;
+			}
+			else if (invokeDetachedSlot(connection, pfnInvoke, pfnInvokeQueued, pfnRelease, pPayload, uPayloadSize))
+			{
+				++iNrOfQueuedSlots;
+			}
+		}
+	}
+	return iNrOfQueuedSlots;
+}
+
+
+bool SignalBase::invokeDetachedSlot(SignalSlotConnection& connection, InvokeFunction pfnInvoke, InvokeFunction pfnInvokeQueued, ReleaseFunction pfnRelease,
+                                    const void* pPayload, unsigned int uPayloadSize)
+{
+	bool bRet = false;
+	if (DirectConnection == connection.m_Type)
+	{
+		invokeSlotDirect(connection.m_Slot, pfnInvoke, pPayload);
+	}
+	else if (NULL != pfnInvokeQueued)
+	{
+		// the connection has no RAM to remember its queued call, so it can't be coalesced
+		connection.m_Type = QueuedConnection;
+		connection.m_iPendingInvoke = -1;
+		if (invokeSlotQueued(connection, pfnInvokeQueued, pfnRelease, pPayload, uPayloadSize))
+		{
+			bRet = true;
+		}
+		else if (RunInline == m_OverflowPolicy)
+		{
+			invokeSlotDirect(connection.m_Slot, pfnInvoke, pPayload);
+		}
+	}
+	else
+	{
+		invokeSlotUnqueued(connection, pfnInvoke, pPayload);
+	}
+	return bRet;
+}
+
+
+void SignalBase::invokeSlotDirect(const DelegateMemento& slot, InvokeFunction pfnInvoke, const void* pPayload)
+{
+	// a direct slot of a signal emitted by a queued slot must not yield (or call again) the queued slot
+	bool bQueuedSlotIsRunning = g_bQueuedSlotIsRunning;
+	g_bQueuedSlotIsRunning = false;
+
+#if SIGNAL_STATISTICS
+	// the slot might delete the signal, so the signal isn't touched after the call
+	++m_uNrOfDirectDeliveries;
+	uint32 uStartTime = system_get_time();
+	pfnInvoke(slot, pPayload);
+	addRuntime(this, system_get_time() - uStartTime);
+#else
+	pfnInvoke(slot, pPayload);
+#endif
+
+	g_bQueuedSlotIsRunning = bQueuedSlotIsRunning;
+}
 
-Signal::SignalSlotConnection Signal::s_listConnections[MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS];
-bool Signal::s_bTaskInvokeSlotIsStarted = false;
 
 
 Signal::Signal()
 {
-	if (false == s_bTaskInvokeSlotIsStarted)
+}
+
+Signal::Signal(const char* strSignalName) : SignalBase(strSignalName)
+{
+}
+
+
+void Signal::emit(void* param)
+{
+	Trace::record(Trace::SignalEmit, this, (uint32)(size_t)param);
+
+	Parameter parameter;
+	parameter.pParameter = param;
+	parameter.iSharedParameter = -1;
+
+	// the parameter must be shared, if there is a queued connection, and the parameter must be freed
+	bool bCanInvokeQueued = true;
+	int iNrOfReservedReferences = 0;
+	if (NULL != param && m_iNrOfQueuedConnections > 0)
+	{
+		parameter.iSharedParameter = acquireSharedParameter(param);
+		if (-1 == parameter.iSharedParameter && DropOldest == getOverflowPolicy() && dropQueuedCallWithSharedParameter())
+		{
+			parameter.iSharedParameter = acquireSharedParameter(param);
+		}
+		// otherwise the queued slots are handled like an overflow of their queue (see dispatch())
+		bCanInvokeQueued = (-1 != parameter.iSharedParameter);
+		if (bCanInvokeQueued)
+		{
+			// the references of the queued slots are taken before dispatch(), because the overflow policy DropOldest
+			// might release the reference of a slot queued by this emit (before the end of dispatch())
+			iNrOfReservedReferences = m_iNrOfQueuedConnections;
+			g_arraySharedParameters[parameter.iSharedParameter].iRefCount += iNrOfReservedReferences;
+		}
+	}
+
+	int iNrOfQueuedSlots = dispatch(&parameter, sizeof(parameter), &invokeSlot, bCanInvokeQueued ? &invokeSlot : NULL, &releaseQueuedParameter);
+
+	if (-1 != parameter.iSharedParameter)
+	{
+		// each queued slot holds its own reference, so param is freed here only if no queued slot could be invoked
+		g_arraySharedParameters[parameter.iSharedParameter].iRefCount += iNrOfQueuedSlots - iNrOfReservedReferences;
+		releaseSharedParameter(parameter.iSharedParameter);
+	}
+	else if (NULL != param)
+	{
+		// there were only direct connections (or the parameter couldn't be shared), so we can release the memory of param now
+		freeParameter(param);
+	}
+}
+
+
+void Signal::invokeSlot(const DelegateMemento& slot, const void* pPayload)
+{
+	VoidFunction fcnt; fcnt.SetMemento(slot);
+	fcnt(static_cast<const Parameter*>(pPayload)->pParameter);
+}
+
+
+void Signal::releaseQueuedParameter(const void* pPayload)
+{
+	int iSharedParameter = static_cast<const Parameter*>(pPayload)->iSharedParameter;
+	if (-1 != iSharedParameter)
 	{
-		s_bTaskInvokeSlotIsStarted = startInvokeTask();
+		releaseSharedParameter(iSharedParameter);
 	}
 }
 
-Signal::Signal(const char* strSignalName)
+
+
+
+struct InvokeData
 {
-	debug("%p Signal::Signal(%s)\n", this, strSignalName);
+	InvokeData() : pfnInvoke(NULL), pfnRelease(NULL), bFanOut(false), pFanOutSignal(NULL), piPendingInvoke(NULL), iNext(-1) {}
+	DelegateMemento functionSlot;
+	SignalBase::InvokeFunction pfnInvoke;
+
+	// releases the payload, if the call is dropped (NULL if the payload doesn't need to be released)
+	SignalBase::ReleaseFunction pfnRelease;
+
+	// fan-out call: all QueuedConnections of pFanOutSignal are called (pFanOutSignal is NULL, if the call has been cancelled)
+	bool bFanOut;
+	SignalBase* pFanOutSignal;
+
+	// points to SignalSlotConnection::m_iPendingInvoke of a CoalescedConnection, otherwise NULL
+	int* piPendingInvoke;
+
+	// index of the next pending invocation (or of the next free entry) in the invoke data array of the same priority, -1 at the end of the list
+	int iNext;
+
+#if SIGNAL_STATISTICS
+	// time of queueing the slot (system_get_time()), and the emitted signal
+	uint32 uQueueTime;
+	const SignalBase* pSignal;
+#endif
+
+	// copy of the parameter of the slot (the union guarantees the alignment)
+	union
+	{
+		void* pPointer;
+		uint32 uInteger;
+		double dFloat;
+		char buffer[MAX_SIZE_OF_INLINE_PAYLOAD];
+	} payload;
+};
+
+#define INVOKE_SLOT 1928
+#define EMIT_FROM_ISR 1929
+
+InvokeData g_arrayInvokeDataLowPriority[MAX_NR_OF_QUEUED_SIGNALS];
+InvokeData g_arrayInvokeDataMediumPriority[MAX_NR_OF_QUEUED_SIGNALS_MEDIUM_PRIORITY];
+InvokeData g_arrayInvokeDataHighPriority[MAX_NR_OF_QUEUED_SIGNALS_HIGH_PRIORITY];
+
+// The event queue of the low priority has room for the EMIT_FROM_ISR event too (at most one of them is pending, see g_bIsrEmitPosted),
+// so a full invoke data array can't make emitFromIsr() fail to post, and a pending EMIT_FROM_ISR can't make a queued slot fail.
+#define EVENT_QUEUE_SIZE_LOW_PRIORITY (MAX_NR_OF_QUEUED_SIGNALS + 1)
+
+os_event_t g_eventQueueLowPriority[EVENT_QUEUE_SIZE_LOW_PRIORITY];
+os_event_t g_eventQueueMediumPriority[MAX_NR_OF_QUEUED_SIGNALS_MEDIUM_PRIORITY];
+os_event_t g_eventQueueHighPriority[MAX_NR_OF_QUEUED_SIGNALS_HIGH_PRIORITY];
+
+
+/* The queued signals of one priority: each priority has its own task, event queue and invoke data array.
+   The pending invocations are chained through InvokeData::iNext, and the slots are called in FIFO order.
+   The free entries are chained through InvokeData::iNext too (as a stack), so queueing a slot takes constant time.
+   The entries after iNrOfInitializedInvokes have never been used, and they are not in the stack of the free entries.
+*/
+struct InvokeQueue
+{
+	InvokeData* pInvokeData;
+	os_event_t* pEventQueue;
+	int iEventQueueSize;
+	int iSize;
+	uint8 uTaskPriority;
+	bool bTaskIsStarted;
+	int iFirstPendingInvoke;
+	int iLastPendingInvoke;
+	int iFirstFreeInvoke;
+	int iNrOfInitializedInvokes;
+
+	// Is there an INVOKE_SLOT event posted, which has not been processed yet? (only used if QUEUED_SIGNALS_TIME_BUDGET_US > 0)
+	bool bInvokeSlotPosted;
+
+	// number of overflows of the queue, indexed by SignalBase::OverflowPolicy (zero initialized, they are not in the initializers below)
+	uint32 arrayNrOfOverflows[SignalBase::RunInline + 1];
+
+#if SIGNAL_STATISTICS
+	// number of used entries of the invoke data, and its maximum since startup (zero initialized too)
+	int iNrOfUsedInvokes;
+	int iHighWaterMark;
+#endif
+};
+
+// indexed by SignalBase::Priority
+InvokeQueue g_arrayInvokeQueues[] =
+{
+	{ g_arrayInvokeDataLowPriority,    g_eventQueueLowPriority,    EVENT_QUEUE_SIZE_LOW_PRIORITY,            MAX_NR_OF_QUEUED_SIGNALS,
+	  USER_TASK_PRIO_0, false, -1, -1, -1, 0, false },
+	{ g_arrayInvokeDataMediumPriority, g_eventQueueMediumPriority, MAX_NR_OF_QUEUED_SIGNALS_MEDIUM_PRIORITY, MAX_NR_OF_QUEUED_SIGNALS_MEDIUM_PRIORITY,
+	  USER_TASK_PRIO_1, false, -1, -1, -1, 0, false },
+	{ g_arrayInvokeDataHighPriority,   g_eventQueueHighPriority,   MAX_NR_OF_QUEUED_SIGNALS_HIGH_PRIORITY,   MAX_NR_OF_QUEUED_SIGNALS_HIGH_PRIORITY,
+	  USER_TASK_PRIO_2, false, -1, -1, -1, 0, false }
+};
 
-	if (false == s_bTaskInvokeSlotIsStarted)
+
+struct IsrEmitData
+{
+	Signal* pSignal;
+	void* pParameter;
+};
+
+// Signals emitted from interrupt handlers (producer: emitFromIsr, consumer: taskInvokeSlot)
+LockFreeQueue<IsrEmitData, MAX_NR_OF_SIGNALS_FROM_ISR> g_queueIsrEmits;
+
+// Is there an EMIT_FROM_ISR event posted, which has not been processed yet? (only the processing of the event clears it)
+volatile bool g_bIsrEmitPosted = false;
+
+
+void emitSignalsFromIsr()
+{
+	IsrEmitData data;
+	while (g_queueIsrEmits.pop(data))
 	{
-		s_bTaskInvokeSlotIsStarted = startInvokeTask();
+		data.pSignal->emit(data.pParameter);
 	}
 }
 
 
+bool postInvokeSlot(InvokeQueue& queue, int iPriority)
+{
+#if QUEUED_SIGNALS_TIME_BUDGET_US > 0
+	// one event processes all the pending invocations, so it is enough to post it once
+	if (!queue.bInvokeSlotPosted)
+	{
+		queue.bInvokeSlotPosted = system_os_post(queue.uTaskPriority, INVOKE_SLOT, iPriority);
+	}
+	return queue.bInvokeSlotPosted;
+#else
+	return system_os_post(queue.uTaskPriority, INVOKE_SLOT, iPriority);
+#endif
+}
 
-void Signal::emit(void* param)
+
+// Returns the index of an unused entry of the invoke data of the queue in constant time, or -1 if all entries are used
+int allocateInvokeData(InvokeQueue& queue)
 {
-	debug("%p >>> emit()\n", this);
+	int iInvoke = -1;
+	if (-1 != queue.iFirstFreeInvoke)
+	{
+		iInvoke = queue.iFirstFreeInvoke;
+		queue.iFirstFreeInvoke = queue.pInvokeData[iInvoke].iNext;
+	}
+	else if (queue.iNrOfInitializedInvokes < queue.iSize)
+	{
+		iInvoke = queue.iNrOfInitializedInvokes;
+		++queue.iNrOfInitializedInvokes;
+	}
 
-	bool bOnlyDirectConnections = true;
-	for (int i = 0; i < MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS; ++i)
+#if SIGNAL_STATISTICS
+	if (-1 != iInvoke)
 	{
-		if (s_listConnections[i].m_Signal == this)
+		++queue.iNrOfUsedInvokes;
+		if (queue.iNrOfUsedInvokes > queue.iHighWaterMark)
 		{
-			if (s_listConnections[i].m_Type == DirectConnection)
-			{
-				// call the slot directly
-				s_listConnections[i].m_Slot(param);
-			}
-			else
-			{
-				// the slot will be invoked later
-				invokeSlotQueued(s_listConnections[i].m_Slot, param);
-				bOnlyDirectConnections = false;
-			}
+			queue.iHighWaterMark = queue.iNrOfUsedInvokes;
 		}
 	}
+#endif
+	return iInvoke;
+}
+
+
+// Removes the first pending invocation from the FIFO of the queue, and returns its index
+int unlinkFirstPendingInvoke(InvokeQueue& queue)
+{
+	int iInvoke = queue.iFirstPendingInvoke;
+	InvokeData& data = queue.pInvokeData[iInvoke];
+	queue.iFirstPendingInvoke = data.iNext;
+	if (-1 == queue.iFirstPendingInvoke)
+	{
+		queue.iLastPendingInvoke = -1;
+	}
+
+	if (NULL != data.piPendingInvoke)
+	{
+		// from now on a new emit of the signal queues a new call
+		*data.piPendingInvoke = -1;
+		data.piPendingInvoke = NULL;
+	}
+	return iInvoke;
+}
+
 
-	if (bOnlyDirectConnections)
+// Calls the slot (or the slots of a fan-out call) of the queued call, and releases the payload.
+// Returns true, if the slot has to be called again (the payload is not released in this case).
+bool callInvokeData(InvokeQueue& queue, InvokeData& data)
+{
+	bool bCallAgain = false;
+	if (data.bFanOut)
 	{
-		// if there were only direct connections, then we can release the memory of param now
-		if (NULL != param)
+		if (NULL != data.pFanOutSignal)
 		{
-			os_free(param);
+			invokeFanOut(data.pFanOutSignal, static_cast<SignalBase::Priority>(&queue - g_arrayInvokeQueues), data.pfnInvoke, &data.payload);
 		}
 	}
 	else
 	{
-		// if there were Queued connections too, then param can be freed after the last slot has been called
-	}
+		g_uSlotStartTime = system_get_time();
+		g_bQueuedSlotIsRunning = true;
+		g_bCallAgain = false;
 
-	debug("%p <<< emit()\n", this);
-}
+		data.pfnInvoke(data.functionSlot, &data.payload);
 
+		g_bQueuedSlotIsRunning = false;
+		bCallAgain = g_bCallAgain;
+	}
 
+	if (!bCallAgain && NULL != data.pfnRelease)
+	{
+		data.pfnRelease(&data.payload);
+	}
+	return bCallAgain;
+}
 
 
-struct InvokeData
+// Appends the (already filled) entry iInvoke to the FIFO of the queue
+void appendPendingInvoke(InvokeQueue& queue, int iInvoke)
 {
-	InvokeData() : bUsed(false) {}
-	bool bUsed;
-	FastDelegate1<void*> functionSlot;
-    void* pParameter;
-};
+	queue.pInvokeData[iInvoke].iNext = -1;
+	if (-1 == queue.iLastPendingInvoke)
+	{
+		queue.iFirstPendingInvoke = iInvoke;
+	}
+	else
+	{
+		queue.pInvokeData[queue.iLastPendingInvoke].iNext = iInvoke;
+	}
+	queue.iLastPendingInvoke = iInvoke;
+}
 
-#define INVOKE_SLOT 1928
 
-InvokeData g_arrayInvokeData[MAX_NR_OF_QUEUED_SIGNALS];
-os_event_t g_eventQueue[MAX_NR_OF_QUEUED_SIGNALS];
+// Calls the first pending slot of the queue. Returns true, if the slot yielded (it has been queued again).
+bool invokeFirstPendingSlot(InvokeQueue& queue)
+{
+	int iInvoke = unlinkFirstPendingInvoke(queue);
+	InvokeData& data = queue.pInvokeData[iInvoke];
 
+#if SIGNAL_STATISTICS
+	uint32 uStartTime = system_get_time();
+	addToHistogram(g_arrayLatencyHistogram, uStartTime - data.uQueueTime);
+	bool bCallAgain = callInvokeData(queue, data);
+	addRuntime(data.pSignal, system_get_time() - uStartTime);
+#else
+	bool bCallAgain = callInvokeData(queue, data);
+#endif
 
-bool isParameterQueuedForOtherSlots(int i, void* param)
-{
-  bool bUsed = false;
-  for (int j = 0; j < MAX_NR_OF_QUEUED_SIGNALS && !bUsed; ++j)
-  {
-	  if (i != j && g_arrayInvokeData[j].pParameter == param)
-	  {
-		  bUsed = true;
-	  }
-  }
-  return bUsed;
+	if (bCallAgain)
+	{
+		// the slot continues its work later with the same payload, after the other pending slots
+#if SIGNAL_STATISTICS
+		data.uQueueTime = system_get_time();
+#endif
+		appendPendingInvoke(queue, iInvoke);
+		if (false == postInvokeSlot(queue, &queue - g_arrayInvokeQueues))
+		{
+			printError("ERROR: The task taskInvokeSlot() couldn't post event. Event queue too small?\n");
+		}
+	}
+	else
+	{
+#if SIGNAL_STATISTICS
+		--queue.iNrOfUsedInvokes;
+#endif
+		// the entry can be reused only after the slot returned (the slot might emit a signal, which queues a new call)
+		data.iNext = queue.iFirstFreeInvoke;
+		queue.iFirstFreeInvoke = iInvoke;
+	}
+	return bCallAgain;
 }
 
 
 void taskInvokeSlot(os_event_t *e)
 {
 	debug(">>> taskInvokeSlot()\n");
+	uint32 uTraceArgument = (e->sig << 16) | (e->par & 0xffff);
+	Trace::record(Trace::TaskInvokeSlotStart, NULL, uTraceArgument);
 
-	if (INVOKE_SLOT == e->sig)
+	if (INVOKE_SLOT == e->sig && e->par <= SignalBase::HighPriority)
 	{
-		int i = e->par;
-		if (0 <= i && i < MAX_NR_OF_QUEUED_SIGNALS && g_arrayInvokeData[i].bUsed)
+		InvokeQueue& queue = g_arrayInvokeQueues[e->par];
+#if QUEUED_SIGNALS_TIME_BUDGET_US > 0
+		// clear the flag before calling the slots, so that a slot which emits a queued signal posts a new event
+		queue.bInvokeSlotPosted = false;
+
+		// a slot, which yielded, is called again only by the next run of the task, so that the other tasks can run in between
+		uint32 uStartTime = system_get_time();
+		bool bYielded = false;
+		while (!bYielded && -1 != queue.iFirstPendingInvoke && system_get_time() - uStartTime < QUEUED_SIGNALS_TIME_BUDGET_US)
+		{
+			bYielded = invokeFirstPendingSlot(queue);
+		}
+
+		if (-1 != queue.iFirstPendingInvoke)
 		{
-			g_arrayInvokeData[i].functionSlot(g_arrayInvokeData[i].pParameter);
-			g_arrayInvokeData[i].bUsed = false;
-			if (NULL != g_arrayInvokeData[i].pParameter)
+			// the time budget is over: let the other tasks (e.g. WiFi) run, and continue later
+			if (false == postInvokeSlot(queue, e->par))
 			{
-				if (isParameterQueuedForOtherSlots(i, g_arrayInvokeData[i].pParameter))
-				{
-					g_arrayInvokeData[i].pParameter = NULL;
-				}
-				else
-				{
-					os_free(g_arrayInvokeData[i].pParameter);
-					g_arrayInvokeData[i].pParameter = NULL;
-				}
+				printError("ERROR: The task taskInvokeSlot() couldn't post event. Event queue too small?\n");
 			}
 		}
+#else
+		if (-1 != queue.iFirstPendingInvoke)
+		{
+			invokeFirstPendingSlot(queue);
+		}
 		else
 		{
-			printError("ERROR: The task taskInvokeSlot() is called with an event with wrong data.\n");
+			printError("ERROR: The task taskInvokeSlot() is called, but there is no queued signal.\n");
 		}
+#endif
+	}
+	else if (EMIT_FROM_ISR == e->sig)
+	{
+		// clear the flag before reading the queue, so that a signal pushed by an interrupt after this point posts a new event
+		// (emitFromIsr() writes the queue and reads the flag in the opposite order, both sides need a full barrier)
+		g_bIsrEmitPosted = false;
+		__sync_synchronize();
 	}
 	else
 	{
 		printError("ERROR: The task taskInvokeSlot() is called with wrong event. Others are posting events with the same priority?\n");
 	}
 
+	// every run of the task empties the queue of the interrupt handlers, so a signal isn't stuck there, if posting EMIT_FROM_ISR failed
+	if (!g_queueIsrEmits.isEmpty())
+	{
+		emitSignalsFromIsr();
+	}
+
+	Trace::record(Trace::TaskInvokeSlotEnd, NULL, uTraceArgument);
 	debug("<<< taskInvokeSlot()\n");
 }
 
-bool Signal::startInvokeTask()
+void detachPendingInvoke(SignalBase::Priority priority, int iInvoke)
 {
-	debug(">>> Signal::startInvokeTask()\n");
-	bool bRet = system_os_task(taskInvokeSlot, PRIORITY_OF_PROCESSING_QUEUED_SIGNALS, g_eventQueue, MAX_NR_OF_QUEUED_SIGNALS);
-	debug("<<< Signal::startInvokeTask() returns %s\n", bRet ? "true":"false");
-	return bRet;
+	g_arrayInvokeQueues[priority].pInvokeData[iInvoke].piPendingInvoke = NULL;
+}
+
+
+void movePendingInvoke(SignalBase::Priority priority, int iInvoke, int* piPendingInvoke)
+{
+	g_arrayInvokeQueues[priority].pInvokeData[iInvoke].piPendingInvoke = piPendingInvoke;
+}
+
+
+void cancelFanOutInvokes(const SignalBase* pSignal)
+{
+	for (int iPriority = SignalBase::LowPriority; iPriority <= SignalBase::HighPriority; ++iPriority)
+	{
+		InvokeQueue& queue = g_arrayInvokeQueues[iPriority];
+		for (int i = queue.iFirstPendingInvoke; -1 != i; i = queue.pInvokeData[i].iNext)
+		{
+			if (pSignal == queue.pInvokeData[i].pFanOutSignal)
+			{
+				queue.pInvokeData[i].pFanOutSignal = NULL;
+			}
+		}
+	}
+}
+
+
+namespace Esp8266Base
+{
+
+void invokeFanOut(SignalBase* pSignal, SignalBase::Priority priority, SignalBase::InvokeFunction pfnInvoke, const void* pPayload)
+{
+	for (int iArray = 0; iArray < MAX_NR_OF_STATIC_CONNECTION_ARRAYS && pSignal->m_bStaticConnections; ++iArray)
+	{
+		const SignalBase::StaticConnections& connections = SignalBase::s_arrayStaticConnections[iArray];
+		for (int i = 0; pSignal == connections.m_pSignal && NULL != connections.m_pConnections[i].pfnGetSlot; ++i)
+		{
+			if (SignalBase::DirectConnection != connections.m_pConnections[i].type && priority == connections.m_pConnections[i].priority)
+			{
+				DelegateMemento slot;
+				connections.m_pConnections[i].pfnGetSlot(connections.m_pReceiver, slot);
+				pfnInvoke(slot, pPayload);
+			}
+		}
+	}
+
+	SignalBase::beginListWalk();
+	int i = pSignal->m_iFirstConnection;
+	while (i != -1)
+	{
+		SignalBase::SignalSlotConnection& connection = SignalBase::s_listConnections[i];
+		// a single-shot connection is always queued on its own (see dispatch()), and removed by then. A connection removed by a slot
+		// is skipped (it keeps its m_iNext until the end of the walk).
+		if (connection.m_Signal == pSignal && SignalBase::QueuedConnection == connection.m_Type && priority == connection.m_Priority &&
+		    !connection.m_bOnce)
+		{
+			pfnInvoke(connection.m_Slot, pPayload);
+		}
+
+		// read after the slot: it might have modified the connections of this signal
+		i = connection.m_iNext;
+	}
+	SignalBase::endListWalk();
+}
+
+}
+
+
+void startInvokeTask(SignalBase::Priority priority)
+{
+	InvokeQueue& queue = g_arrayInvokeQueues[priority];
+	if (false == queue.bTaskIsStarted)
+	{
+		debug(">>> Signal::startInvokeTask(%d)\n", priority);
+		queue.bTaskIsStarted = system_os_task(taskInvokeSlot, queue.uTaskPriority, queue.pEventQueue, queue.iEventQueueSize);
+		debug("<<< Signal::startInvokeTask() returns %s\n", queue.bTaskIsStarted ? "true":"false");
+	}
 }
 
-bool Signal::invokeSlotQueued(FastDelegate1<void*> functionSlot, void* pParameter)
+bool SignalBase::invokeSlotQueued(SignalSlotConnection& connection, InvokeFunction pfnInvoke, ReleaseFunction pfnRelease, const void* pPayload, unsigned int uPayloadSize,
+                                  bool bFanOut)
 {
 	debug(">>> Signal::invokeSlotQueued()\n");
 
+	InvokeQueue& queue = g_arrayInvokeQueues[connection.m_Priority];
+	InvokeData* pInvokeData = queue.pInvokeData;
+
+	if (-1 != connection.m_iPendingInvoke)
+	{
+		// CoalescedConnection: the queued call gets the newer parameter, and the older one is released
+		InvokeData& data = pInvokeData[connection.m_iPendingInvoke];
+		if (NULL != pfnRelease)
+		{
+			pfnRelease(&data.payload);
+		}
+		os_memcpy(data.payload.buffer, pPayload, uPayloadSize);
+
+		debug("<<< Signal::invokeSlotQueued() coalesced\n");
+		return true;
+	}
+
 	bool bRet = false;
-	int i = 0;
-	while (i < MAX_NR_OF_QUEUED_SIGNALS && g_arrayInvokeData[i].bUsed)
+	bool bPostEvent = true;
+	int i = allocateInvokeData(queue);
+	if (-1 == i)
 	{
-		++i;
+		++queue.arrayNrOfOverflows[m_OverflowPolicy];
+		if (DropOldest == m_OverflowPolicy && -1 != queue.iFirstPendingInvoke)
+		{
+			// the entry of the oldest call is reused, and its parameter is released
+			i = unlinkFirstPendingInvoke(queue);
+			if (NULL != pInvokeData[i].pfnRelease)
+			{
+				pInvokeData[i].pfnRelease(&pInvokeData[i].payload);
+			}
+
+			// without a time budget the event of the dropped call will call the new one
+			bPostEvent = (QUEUED_SIGNALS_TIME_BUDGET_US > 0);
+		}
+		else if (DropNewest == m_OverflowPolicy)
+		{
+			printError("ERROR: Signal::invokeSlotQueued couldn't post event. Invoke data array too small?\n");
+		}
 	}
 
-	if (0 <= i && i < MAX_NR_OF_QUEUED_SIGNALS)
+	if (-1 != i)
 	{
-		g_arrayInvokeData[i].bUsed = true;
-		g_arrayInvokeData[i].functionSlot = functionSlot;
-		g_arrayInvokeData[i].pParameter = pParameter;
+		pInvokeData[i].functionSlot = connection.m_Slot;
+		pInvokeData[i].pfnInvoke = pfnInvoke;
+		pInvokeData[i].pfnRelease = pfnRelease;
+		pInvokeData[i].bFanOut = bFanOut;
+		pInvokeData[i].pFanOutSignal = bFanOut ? this : NULL;
+		os_memcpy(pInvokeData[i].payload.buffer, pPayload, uPayloadSize);
+
+#if SIGNAL_STATISTICS
+		pInvokeData[i].uQueueTime = system_get_time();
+		pInvokeData[i].pSignal = this;
+		++m_uNrOfQueuedDeliveries;
+#endif
+
+		if (CoalescedConnection == connection.m_Type)
+		{
+			connection.m_iPendingInvoke = i;
+			pInvokeData[i].piPendingInvoke = &connection.m_iPendingInvoke;
+		}
 
-		bRet = system_os_post(PRIORITY_OF_PROCESSING_QUEUED_SIGNALS, INVOKE_SLOT, i);
+		appendPendingInvoke(queue, i);
 
-		if (false == bRet)
+		// the slot is queued even if posting fails: it will be called after the next successfully posted event
+		bRet = true;
+		if (bPostEvent && false == postInvokeSlot(queue, connection.m_Priority))
 		{
 		   printError("ERROR: Signal::invokeSlotQueued couldn't post event. Event queue too small?\n");
 		}
 	}
+
+	debug("<<< Signal::invokeSlotQueued() returns %s\n", bRet ? "true":"false");
+
+	return bRet;
+}
+
+
+void SignalBase::invokeSlotUnqueued(const SignalSlotConnection& connection, InvokeFunction pfnInvoke, const void* pPayload)
+{
+	InvokeQueue& queue = g_arrayInvokeQueues[connection.m_Priority];
+	if (RunInline == m_OverflowPolicy)
+	{
+		++queue.arrayNrOfOverflows[RunInline];
+
+		// the parameter is still owned by emit()
+		invokeSlotDirect(connection.m_Slot, pfnInvoke, pPayload);
+	}
 	else
 	{
-		printError("ERROR: Signal::invokeSlotQueued couldn't post event. Invoke data array too small?\n");
+		// DropOldest couldn't make room for the parameter either (see Signal::emit())
+		++queue.arrayNrOfOverflows[DropNewest];
+		printError("ERROR: Signal::emit couldn't share the parameter with a queued slot. MAX_NESTING_OF_EMITS too small?\n");
 	}
+}
 
-	debug("<<< Signal::invokeSlotQueued() returns %s\n", bRet ? "true":"false");
+
+bool Signal::dropQueuedCallWithSharedParameter()
+{
+	for (int iPriority = LowPriority; iPriority <= HighPriority; ++iPriority)
+	{
+		InvokeQueue& queue = g_arrayInvokeQueues[iPriority];
+		for (int i = queue.iFirstPendingInvoke; -1 != i; i = queue.pInvokeData[i].iNext)
+		{
+			InvokeData& data = queue.pInvokeData[i];
+			const Parameter* pParameter = reinterpret_cast<const Parameter*>(data.payload.buffer);
+			if (&releaseQueuedParameter == data.pfnRelease && 1 == g_arraySharedParameters[pParameter->iSharedParameter].iRefCount)
+			{
+				// the entry stays in the queue (its event is already posted), but it doesn't call anything anymore
+				data.pfnRelease(&data.payload);
+				data.pfnRelease = NULL;
+				data.pfnInvoke = &invokeNothing;
+				data.pFanOutSignal = NULL;
+				if (NULL != data.piPendingInvoke)
+				{
+					*data.piPendingInvoke = -1;
+					data.piPendingInvoke = NULL;
+				}
+				++queue.arrayNrOfOverflows[DropOldest];
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+
+bool SignalBase::yieldIfTimeSliceOver(uint32 uTimeSliceUs)
+{
+	bool bRet = isTimeSliceOver(uTimeSliceUs);
+	if (bRet)
+	{
+		callAgain();
+	}
+	return bRet;
+}
+
+
+bool SignalBase::isTimeSliceOver(uint32 uTimeSliceUs)
+{
+	return g_bQueuedSlotIsRunning && system_get_time() - g_uSlotStartTime >= uTimeSliceUs;
+}
+
+
+void SignalBase::callAgain()
+{
+	if (g_bQueuedSlotIsRunning)
+	{
+		g_bCallAgain = true;
+	}
+}
+
+
+uint32 SignalBase::getNrOfOverflows(Priority priority, OverflowPolicy policy)
+{
+	return g_arrayInvokeQueues[priority].arrayNrOfOverflows[policy];
+}
+
+
+#if SIGNAL_STATISTICS
+int SignalBase::getQueueHighWaterMark(Priority priority)
+{
+	return g_arrayInvokeQueues[priority].iHighWaterMark;
+}
+
+
+const uint32* SignalBase::getLatencyHistogram()
+{
+	return g_arrayLatencyHistogram;
+}
+
+
+const uint32* SignalBase::getRuntimeHistogram()
+{
+	return g_arrayRuntimeHistogram;
+}
+
+
+uint32 SignalBase::getMaxRuntime(const SignalBase** ppSignal)
+{
+	if (NULL != ppSignal)
+	{
+		*ppSignal = g_pSlowestSignal;
+	}
+	return g_uMaxRuntime;
+}
+
+
+void SignalBase::printStatistics()
+{
+	print("SIGSTAT hwm=%d/%d,%d/%d,%d/%d lat=",
+	      g_arrayInvokeQueues[LowPriority].iHighWaterMark, g_arrayInvokeQueues[LowPriority].iSize,
+	      g_arrayInvokeQueues[MediumPriority].iHighWaterMark, g_arrayInvokeQueues[MediumPriority].iSize,
+	      g_arrayInvokeQueues[HighPriority].iHighWaterMark, g_arrayInvokeQueues[HighPriority].iSize);
+	for (int i = 0; i < NR_OF_HISTOGRAM_BUCKETS; ++i)
+	{
+		print(0 == i ? "%u" : ",%u", g_arrayLatencyHistogram[i]);
+	}
+	print(" run=");
+	for (int i = 0; i < NR_OF_HISTOGRAM_BUCKETS; ++i)
+	{
+		print(0 == i ? "%u" : ",%u", g_arrayRuntimeHistogram[i]);
+	}
+	print(" max=%u@%p\n", g_uMaxRuntime, g_pSlowestSignal);
+}
+#endif
+
+
+bool Signal::emitFromIsr(void* pParameter)
+{
+	IsrEmitData data;
+	data.pSignal = this;
+	data.pParameter = pParameter;
+
+	bool bRet = g_queueIsrEmits.push(data);
+
+	// the flag is read only after the new element is visible for the task (see taskInvokeSlot())
+	__sync_synchronize();
+	if (bRet && !g_bIsrEmitPosted)
+	{
+		// one event is enough for all the signals in the queue, and if posting fails, the next emitFromIsr() (or the next run of the
+		// task) takes care of the queue. The flag is set before posting, because the task clears it when it processes the event.
+		g_bIsrEmitPosted = true;
+		if (!system_os_post(USER_TASK_PRIO_0, EMIT_FROM_ISR, 0))
+		{
+			g_bIsrEmitPosted = false;
+		}
+	}
 
 	return bRet;
 }
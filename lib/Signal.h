@@ -5,16 +5,81 @@
 /* *************     Configuration settings                ****************** */
 /* ************************************************************************** */
 
+/* Each setting can be overridden by the application without editing the library: either in user_config.h (which is part of
+   every ESP8266 SDK project), or with -D in the Makefile. So e.g. a sensor node can use small tables, and a gateway big ones.
+*/
+extern "C"
+{
+  #include <user_config.h>
+}
+
 // maximum number of simultaneous signal-slot connections
+#ifndef MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS
 #define MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS 100
+#endif
+
+// maximum number of arrays of static connections of all signals (see SignalBase::connectStatic()). Each one needs 12 bytes of RAM, the
+// signals without static connections don't pay anything for them.
+#ifndef MAX_NR_OF_STATIC_CONNECTION_ARRAYS
+#define MAX_NR_OF_STATIC_CONNECTION_ARRAYS 4
+#endif
 
-// maximum number of queued signals
+// maximum number of queued signals of the connections with LowPriority
+#ifndef MAX_NR_OF_QUEUED_SIGNALS
 #define MAX_NR_OF_QUEUED_SIGNALS 10
+#endif
+
+// maximum number of queued signals of the connections with MediumPriority and HighPriority
+#ifndef MAX_NR_OF_QUEUED_SIGNALS_MEDIUM_PRIORITY
+#define MAX_NR_OF_QUEUED_SIGNALS_MEDIUM_PRIORITY 4
+#endif
+#ifndef MAX_NR_OF_QUEUED_SIGNALS_HIGH_PRIORITY
+#define MAX_NR_OF_QUEUED_SIGNALS_HIGH_PRIORITY 4
+#endif
 
-// priority of the task, which is processing the queued signal (0 is lowest priority)
-#define PRIORITY_OF_PROCESSING_QUEUED_SIGNALS USER_TASK_PRIO_0
-//#define PRIORITY_OF_PROCESSING_QUEUED_SIGNALS USER_TASK_PRIO_1
-//#define PRIORITY_OF_PROCESSING_QUEUED_SIGNALS USER_TASK_PRIO_2
+// maximum size (in bytes) of the parameter of a TypedSignal (and of all parameters of a TypedSignal2..4 together). The parameter of a
+// queued slot is copied into the queue, so this value multiplies with MAX_NR_OF_QUEUED_SIGNALS. (The minimum is 8, which is needed for
+// the parameter of Signal)
+#ifndef MAX_SIZE_OF_INLINE_PAYLOAD
+#define MAX_SIZE_OF_INLINE_PAYLOAD 8
+#endif
+
+// maximum nesting depth of Signal::emit() with a parameter (a slot emits a signal, whose slot emits a signal, ...), which is guaranteed
+// to share its parameter with the queued slots even if all queues are full. Each level needs 8 bytes of RAM. A deeper emit handles its
+// queued slots like an overflow of the queue (see SignalBase::OverflowPolicy).
+#ifndef MAX_NESTING_OF_EMITS
+#define MAX_NESTING_OF_EMITS 4
+#endif
+
+// maximum number of signals, which can be emitted from interrupt handlers before the task processes them (must be a power of two)
+#ifndef MAX_NR_OF_SIGNALS_FROM_ISR
+#define MAX_NR_OF_SIGNALS_FROM_ISR 16
+#endif
+
+/* Processing of the queued signals:
+   - 0: each queued signal is processed by a separate run of the task (one event in the event queue of the task per queued signal)
+   - otherwise: one run of the task calls all the queued slots, until this time (in microseconds) is over. The remaining slots are called by the
+     next run of the task, so that the other tasks (e.g. WiFi) can run in between.
+*/
+#ifndef QUEUED_SIGNALS_TIME_BUDGET_US
+#define QUEUED_SIGNALS_TIME_BUDGET_US 0
+//#define QUEUED_SIGNALS_TIME_BUDGET_US 2000
+#endif
+
+/* Statistics of the signals: number of emits and deliveries of each signal, high-water marks of the queues, histograms of the latency
+   of the queued slots and of the runtime of the slots (see SignalBase::printStatistics())
+   - 0: no statistics (no RAM and runtime overhead)
+   - 1: the statistics are collected (it costs two calls of system_get_time() for each called slot)
+*/
+#ifndef SIGNAL_STATISTICS
+#define SIGNAL_STATISTICS 0
+//#define SIGNAL_STATISTICS 1
+#endif
+
+// default time slice (in microseconds) of a queued slot, see SignalBase::yieldIfTimeSliceOver()
+#ifndef QUEUED_SLOT_TIME_SLICE_US
+#define QUEUED_SLOT_TIME_SLICE_US 5000
+#endif
 
 /* *************     End configuration settings           ******************* */
 
@@ -29,6 +94,7 @@ extern "C"
 }
 
 #include "FastDelegate.h"
+#include "Trace.h"
 
 namespace Esp8266Base
 {
@@ -36,40 +102,562 @@ namespace Esp8266Base
 using namespace fastdelegate;
 
 
+/* \class SignalBase
+   \brief Common part of Signal and TypedSignal: stores the signal-slot connections, and calls the slots directly or queued
+   
+   The slots are stored as DelegateMemento, so that the connections of signals with different parameter types can share the same list.
+   The parameter of a queued slot is copied into the queue (no dynamic heap management), and the slot is called by a task later.
+*/
+class SignalBase
+{
+public:
+	
+	enum ConnectionType
+	{
+		//! The slot will be directly called from emit()
+		DirectConnection,
+		
+		//! The slot won't be called from emit(). The slot will be called later, scheduled by the chip's scheduler
+		QueuedConnection,
+
+		/*! Like QueuedConnection, but the connection has at most one queued call of the slot. If the signal is emitted again before
+		    the slot has been called, then the parameter of the queued call is replaced by the newer one (and the older one is freed).
+		    Useful for signals, where only the newest value matters (e.g. measurements of a sensor).
+		*/
+		CoalescedConnection
+	};
+
+	/* Priority of a QueuedConnection (or CoalescedConnection). Each priority has its own task (with the priority USER_TASK_PRIO_0..2), its own event queue and
+	   its own list of queued signals. So a flood of queued signals with low priority can't delay the slots with higher priority.
+	   The tasks with MediumPriority and HighPriority are only started, if there is a connection with the priority, so the application can use
+	   these task priorities for its own purposes, if it doesn't use the priorities of the signals.
+	*/
+	enum Priority
+	{
+		//! The slot is called by the task with priority USER_TASK_PRIO_0
+		LowPriority,
+
+		//! The slot is called by the task with priority USER_TASK_PRIO_1
+		MediumPriority,
+
+		//! The slot is called by the task with priority USER_TASK_PRIO_2
+		HighPriority
+	};
+
+	/* What happens, if a slot should be queued, but the invoke data of its priority is full (see MAX_NR_OF_QUEUED_SIGNALS), or the
+	   parameter of Signal::emit() can't be shared with the queued slots (the emits are nested deeper than MAX_NESTING_OF_EMITS).
+	   In all cases the parameter of the dropped call is released, so an overload can't leak memory.
+	*/
+	enum OverflowPolicy
+	{
+		//! The new call of the slot is dropped (default)
+		DropNewest,
+
+		/*! The oldest queued call of the priority is removed (and its parameter is released), and the new call is queued.
+		    If the parameter can't be shared, the oldest queued call of Signal (the lower priorities first), which holds the last
+		    reference to its parameter, is dropped. If there isn't any, the new call is dropped like with DropNewest.
+		*/
+		DropOldest,
+
+		//! The slot is called directly from emit(), like a DirectConnection
+		RunInline
+	};
+	
+	/* Function which restores the delegate from slot, and calls it with the parameter stored in pPayload.
+	   Each type of signals provides its own function, because only the signal knows the type of the slot and of the parameter.
+	*/
+	typedef void (*InvokeFunction)(const DelegateMemento& slot, const void* pPayload);
+
+	/* Function which releases the parameter stored in pPayload without calling the slot (e.g. if the queued call has been coalesced).
+	*/
+	typedef void (*ReleaseFunction)(const void* pPayload);
+
+	/* Function which creates the slot of a static connection for the receiver object.
+	*/
+	typedef void (*GetSlotFunction)(void* pReceiver, DelegateMemento& slot);
+
+	/* A connection, which is known at compile time. An array of static connections can be stored in flash (with ICACHE_RODATA_ATTR),
+	   so unlike the connections made by connect(), it doesn't use any RAM. The array must be terminated by an element with pfnGetSlot = NULL.
+	   The pfnGetSlot of the elements is created by Signal::staticSlot() (or TypedSignal::staticSlot()), e.g.:
+	   const SignalBase::StaticConnection MyClass::s_connections[] ICACHE_RODATA_ATTR = {
+	       {&Signal::staticSlot<MyClass, &MyClass::mySlot>, SignalBase::DirectConnection, SignalBase::LowPriority},
+	       {NULL, SignalBase::DirectConnection, SignalBase::LowPriority}
+	   };
+	   The flash can only be read with aligned 32 bit access, so all members have the size of 32 bits.
+	   A CoalescedConnection isn't possible, because it would need RAM for its queued call (it behaves like a QueuedConnection).
+	*/
+	struct StaticConnection
+	{
+		GetSlotFunction pfnGetSlot;
+		ConnectionType type;
+		Priority priority;
+	};
+
+
+	/* Handle of a connection made by connect() (or -1, if the connection failed). It contains the index of a handle slot, which refers to the
+	   entry of the connection (the entries are moved, when the table is compacted), and a generation counter, which is incremented whenever
+	   the connection is removed. So a handle of a removed connection never refers to a newer connection (until the counter wraps around
+	   after 32768 connections with the same handle slot).
+	*/
+	typedef int ConnectionHandle;
+
+
+	/*! Removes the connection of the handle in constant time. Returns 1, or 0 if the handle doesn't refer to a connection of this signal
+	    (e.g. because it has already been removed).
+	*/
+	int disconnect(ConnectionHandle handle);
+
+
+	/*! Returns true, if the handle refers to a connection of this signal, which hasn't been removed.
+	*/
+	bool isConnected(ConnectionHandle handle) const;
+
+
+	/*! Returns the number of connections of all signals (made by connect(), the static connections are not counted).
+	*/
+	static int getNrOfConnections();
+
+
+	/*! Returns the highest number of simultaneous connections since startup, which helps to choose MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS.
+	*/
+	static int getConnectionHighWaterMark();
+
+
+	/*! Connects the signal to the static connections of pConnections (an array in flash, terminated by an element with pfnGetSlot = NULL).
+	    The slots are called for the object pReceiver, which must have the type of the receiver class of the static connections.
+	    A signal can have more arrays of static connections (e.g. for different receivers), and their slots are called before the slots
+	    connected by connect(). Returns false, if MAX_NR_OF_STATIC_CONNECTION_ARRAYS is too small for the application.
+	*/
+	bool connectStatic(const StaticConnection* pConnections, void* pReceiver);
+
+
+	/*! Removes the static connections of pConnections for the object pReceiver. Returns false, if they aren't connected to this signal.
+	*/
+	bool disconnectStatic(const StaticConnection* pConnections, void* pReceiver);
+
+
+	/*! Sets the overflow policy of the queued connections of this signal. The default is DropNewest.
+	*/
+	void setOverflowPolicy(OverflowPolicy policy) { m_OverflowPolicy = policy; }
+
+	/*! Returns the overflow policy of the queued connections of this signal.
+	*/
+	OverflowPolicy getOverflowPolicy() const { return static_cast<OverflowPolicy>(m_OverflowPolicy); }
+
+
+	/*! Switches the fan-out mode of the signal on or off (default: off).
+	    In fan-out mode an emit() uses only one queue entry (and one event) for each priority, instead of one for each QueuedConnection.
+	    The task calls the slots of all QueuedConnections of the priority, and releases the parameter once afterwards. So broadcast-style
+	    signals with many queued connections need much less of MAX_NR_OF_QUEUED_SIGNALS.
+	    The slots are called with the connections, which exist when the task runs (not when the signal has been emitted).
+	    CoalescedConnections are not affected.
+	    The queue entries refer to the signal, so a signal in fan-out mode must not be deleted while it has queued calls. Switching off the
+	    fan-out mode cancels the queued fan-out calls (their parameter is released), so call setFanOut(false) before deleting such a signal.
+	*/
+	void setFanOut(bool bFanOut);
+
+
+	/*! Returns, how many times the queue of the priority was full, and the overflow was handled with the policy (since startup).
+	    For DropNewest and DropOldest it is the number of dropped calls, for RunInline the number of slots called directly.
+	*/
+	static uint32 getNrOfOverflows(Priority priority, OverflowPolicy policy);
+
+
+	/*! Cooperative time slicing of long-running queued slots. A queued slot, which has a lot of work (e.g. formats many JSON records),
+	    can split its work into small steps, and it can check after each step, whether its time slice is over:
+
+	    void MyClass::formatRecords(void* pRecords)
+	    {
+	        while (m_iNextRecord < m_iNrOfRecords)
+	        {
+	            formatRecord(m_iNextRecord++);
+	            if (SignalBase::yieldIfTimeSliceOver())
+	            {
+	                return;  // the slot will be called again with the same parameter
+	            }
+	        }
+	        m_iNextRecord = 0;
+	    }
+
+	    If the time slice is over, the slot is queued again (at the end of the queue of its priority, with the same parameter, which is not
+	    released in between), and it returns true. So the other tasks (e.g. WiFi) can run, before the slot continues its work. The state
+	    of the work must be stored by the receiver object.
+	    It has an effect only if it is called by a slot of a QueuedConnection or CoalescedConnection (otherwise it returns false), but not
+	    in fan-out mode (see setFanOut()). A direct slot of a signal emitted by the queued slot isn't the queued slot: it gets false too.
+	*/
+	static bool yieldIfTimeSliceOver(uint32 uTimeSliceUs = QUEUED_SLOT_TIME_SLICE_US);
+
+
+	/*! Returns true, if the running queued slot has been running for more than uTimeSliceUs microseconds.
+	    (Returns false, if no queued slot is running.)
+	*/
+	static bool isTimeSliceOver(uint32 uTimeSliceUs = QUEUED_SLOT_TIME_SLICE_US);
+
+
+	/*! The running queued slot will be queued again with the same parameter after it returned (see yieldIfTimeSliceOver()).
+	*/
+	static void callAgain();
+
+#if SIGNAL_STATISTICS
+	/* Number of buckets of the histograms. The bucket i counts the durations below (16 << 2*i) microseconds (16us, 64us, 256us, ...),
+	   and the last bucket counts all the longer durations.
+	*/
+	enum { NR_OF_HISTOGRAM_BUCKETS = 8 };
+
+	/*! Returns the number of emits of this signal.
+	*/
+	uint32 getNrOfEmits() const { return m_uNrOfEmits; }
+
+	/*! Returns the number of slots called directly by emit() of this signal.
+	*/
+	uint32 getNrOfDirectDeliveries() const { return m_uNrOfDirectDeliveries; }
+
+	/*! Returns the number of slots of this signal, which have been put into a queue.
+	*/
+	uint32 getNrOfQueuedDeliveries() const { return m_uNrOfQueuedDeliveries; }
+
+	/*! Returns the highest number of simultaneously queued slots with the priority since startup.
+	*/
+	static int getQueueHighWaterMark(Priority priority);
+
+	/*! Returns the histogram (NR_OF_HISTOGRAM_BUCKETS elements) of the time between queueing a slot and calling it.
+	*/
+	static const uint32* getLatencyHistogram();
+
+	/*! Returns the histogram (NR_OF_HISTOGRAM_BUCKETS elements) of the runtime of the slots (both direct and queued).
+	*/
+	static const uint32* getRuntimeHistogram();
+
+	/*! Returns the longest runtime of a slot in microseconds, and the signal of the slot.
+	*/
+	static uint32 getMaxRuntime(const SignalBase** ppSignal = NULL);
+
+	/*! Prints the statistics in one line:
+	    "SIGSTAT hwm=<low>/<size>,<medium>/<size>,<high>/<size> lat=<histogram> run=<histogram> max=<us>@<signal>"
+	*/
+	static void printStatistics();
+#endif
+
+protected:
+
+	/*! Default constructor.
+	*/
+	SignalBase();
+
+	
+	/*! Constructor which prints the this pointer and the name of the signal. It makes debugging easier, if you which this-pointer belongs to which signal.
+    */
+	SignalBase(const char* strSignalName);
+
+
+	/*! Destructor, which removes the connections of the signal (the static ones too), and cancels its queued fan-out calls. The entries of
+	    a deleted signal would be moved by the compaction of the table otherwise, which updates their signal. The queued calls of the other
+	    connections are still executed (they don't refer to the signal).
+	*/
+	~SignalBase();
+
+	
+	/* Stores the connection of this signal to the slot.
+	   Returns the handle of the connection, or -1 if the list of connections is full.
+	   If bOnce is true, then the connection is removed, when the slot is called (or queued) the first time.
+	*/
+	int connectSlot(const DelegateMemento& slot, ConnectionType connectionType, Priority priority, bool bOnce = false);
+
+	
+	/* Removes all connections of this signal to the slot, and returns the number of removed connections
+	*/
+	int disconnectSlot(const DelegateMemento& slot);
+
+	
+	/* Calls the connected slots. The slots with DirectConnection are called with pfnInvoke(slot, pPayload).
+	   For the slots with QueuedConnection uPayloadSize bytes of pPayload are copied, and pfnInvokeQueued is called later with the copy.
+	   If pfnInvokeQueued is NULL, then the slots with QueuedConnection can't be queued: they are handled like an overflow of their queue
+	   (see OverflowPolicy). The copy is released with pfnRelease (if it is not NULL), after the queued slot has been called, or if the
+	   queued call is dropped or coalesced.
+	   Returns the number of queued slots (including the coalesced ones).
+	*/
+	int dispatch(const void* pPayload, unsigned int uPayloadSize, InvokeFunction pfnInvoke, InvokeFunction pfnInvokeQueued, ReleaseFunction pfnRelease);
+
+
+	// Number of connections with QueuedConnection or CoalescedConnection of this signal (static connections included)
+	// (16 bit, so that together with m_iFirstConnection it needs only one word of each signal)
+	sint16 m_iNrOfQueuedConnections;
+
+private:
+
+	// The index of a connection must fit into m_iFirstConnection (the array size is negative otherwise, and the compilation fails)
+	typedef char ConnectionIndexMustFitInto16Bits[MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS <= 32767 ? 1 : -1];
+
+	// disable copy constructor
+	SignalBase(const SignalBase&);
+	
+	// disable operator=
+	SignalBase& operator=(const SignalBase&);
+	
+
+	struct SignalSlotConnection
+	{
+		SignalSlotConnection() : m_Signal(0), m_iNext(-1) {  }
+		SignalBase* m_Signal;
+		DelegateMemento m_Slot;
+
+		// ConnectionType and Priority (8 bit, so that the entry has only 32 bytes)
+		uint8 m_Type;
+		uint8 m_Priority;
+
+		// the connection is removed, when its slot is called (or queued) the first time (see connectOnce())
+		bool m_bOnce;
+
+		// index of the queued call of a CoalescedConnection in the invoke data of its priority, -1 if there is no queued call.
+		// After the connection has been removed during a walk, the next removed entry, which waits for the compaction.
+		int m_iPendingInvoke;
+
+		// index of the next connection of the same signal in s_listConnections, -1 at the end of the list
+		sint16 m_iNext;
+
+		// index of the previous connection of the same signal in s_listConnections (the first connection stores the last one),
+		// so that a connection can be removed and appended in constant time
+		sint16 m_iPrevious;
+
+		// index of the handle slot of the connection in s_arrayHandleSlots
+		sint16 m_iHandleSlot;
+	};
+
+	// Indirection between a ConnectionHandle and the entry of the connection, which can be moved
+	struct HandleSlot
+	{
+		// index of the entry in s_listConnections, or the next free handle slot (-1 at the end), while the handle slot is not used
+		sint16 iConnectionIndex;
+
+		// incremented (modulo 2^15), when the connection is removed
+		uint16 uGeneration;
+	};
+
+
+	/* List of all signal-slot connections. The table is kept compact: the used entries are always s_listConnections[0..s_iNrOfUsedEntries-1],
+	   because the last entry is moved into the place of a removed one. So connect() and disconnect() never look beyond the used entries.
+	   While a connection list is walked (e.g. by emit()), the entries are not moved: the removed ones are only marked (m_Signal = 0), and
+	   the table is compacted after the last walk.
+	*/
+	static SignalSlotConnection s_listConnections[MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS];
+
+	// Number of used entries at the beginning of s_listConnections (including the removed ones, which haven't been compacted yet)
+	static int s_iNrOfUsedEntries;
+
+	// Number of connections, and its highest value since startup
+	static int s_iNrOfConnections;
+	static int s_iConnectionHighWaterMark;
+
+	// Handle slots of the connections, with a stack of the free ones (chained through HandleSlot::iConnectionIndex), and the number of
+	// handle slots, which have been used already (the ones after them have never been used)
+	static HandleSlot s_arrayHandleSlots[MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS];
+	static int s_iFirstFreeHandleSlot;
+	static int s_iNrOfInitializedHandleSlots;
+
+	// Number of connection lists, which are walked at the moment (emit() can be nested), and the first of the removed entries, which wait
+	// for the compaction (-1 if there is none), so the compaction doesn't need to scan the table
+	static int s_iNrOfListWalks;
+	static int s_iFirstRemovedEntry;
+
+	// Returns the index of an unused entry of s_listConnections (with a handle slot) in constant time, or -1 if all entries are used
+	static int allocateConnection();
+
+	// Releases the entry iConnectionIndex of s_listConnections and its handle slot, and compacts the table (or marks it for compaction)
+	static void releaseConnection(int iConnectionIndex);
+
+	// Moves the last used entry into the removed entry iConnectionIndex (if the last one hasn't been removed too)
+	static void fillEntry(int iConnectionIndex);
+
+	// Moves the connection from entry iFrom to entry iTo, and updates all indices and pointers, which refer to it
+	static void moveConnection(int iFrom, int iTo);
+
+	// Must be called before and after walking a connection list, whose slots might remove connections
+	static void beginListWalk();
+	static void endListWalk();
+
+	// Returns the index of the connection of the handle in s_listConnections, or -1 if it isn't a valid connection of this signal
+	int findConnection(ConnectionHandle handle) const;
+
+	// Index of the first connection of this signal in s_listConnections, -1 if the signal is not connected.
+	// The connections of one signal are chained through SignalSlotConnection::m_iNext, so emit() doesn't need to scan the whole table.
+	sint16 m_iFirstConnection;
+
+	// An array of static connections (in flash) of a signal, and the receiver object of their slots
+	struct StaticConnections
+	{
+		SignalBase* m_pSignal;
+		const StaticConnection* m_pConnections;
+		void* m_pReceiver;
+	};
+
+	// The static connections of all signals (m_pSignal is NULL in the unused elements), so a signal only needs a flag for them
+	static StaticConnections s_arrayStaticConnections[MAX_NR_OF_STATIC_CONNECTION_ARRAYS];
+
+	// OverflowPolicy (8 bit, so that a signal has only 8 bytes)
+	uint8 m_OverflowPolicy;
+	bool m_bFanOut;
+
+	// true, if the signal has static connections in s_arrayStaticConnections
+	bool m_bStaticConnections;
+
+#if SIGNAL_STATISTICS
+	uint32 m_uNrOfEmits;
+	uint32 m_uNrOfDirectDeliveries;
+	uint32 m_uNrOfQueuedDeliveries;
+#endif
+
+	// Returns the number of static connections with a queued type in pConnections
+	static int countQueuedStaticConnections(const StaticConnection* pConnections);
+
+	// Calls or queues the slots of the static connections of this signal (see dispatch()). Returns the number of queued slots.
+	int dispatchStatic(bool* pFanOut, InvokeFunction pfnInvoke, InvokeFunction pfnInvokeQueued, ReleaseFunction pfnRelease,
+	                   const void* pPayload, unsigned int uPayloadSize);
+
+	// Appends the (already filled) entry iConnectionIndex of s_listConnections to the connection list of this signal
+	void appendConnection(int iConnectionIndex);
+
+	// Removes the entry iConnectionIndex of s_listConnections from the connection list of this signal in constant time, and releases it
+	void removeConnection(int iConnectionIndex);
+
+	/* Calls or queues the slot of a connection, which is not in the connection list (a static connection, or a removed single-shot connection),
+	   like dispatch() does it for the connections in the list. Returns true, if the slot has been queued.
+	*/
+	bool invokeDetachedSlot(SignalSlotConnection& connection, InvokeFunction pfnInvoke, InvokeFunction pfnInvokeQueued, ReleaseFunction pfnRelease,
+	                        const void* pPayload, unsigned int uPayloadSize);
+
+	// Calls the slot of a DirectConnection (and updates the statistics)
+	void invokeSlotDirect(const DelegateMemento& slot, InvokeFunction pfnInvoke, const void* pPayload);
+
+	// Applies the overflow policy to a queued connection, whose slot can't be queued, because dispatch() got no pfnInvokeQueued
+	void invokeSlotUnqueued(const SignalSlotConnection& connection, InvokeFunction pfnInvoke, const void* pPayload);
+
+	/* Sends an event to the task of the priority of the connection to call its slot with a copy of the payload (or replaces the payload of a coalesced call)
+	   If bFanOut is true, then the task calls all QueuedConnections of the priority with pfnInvoke, and releases the payload with pfnRelease afterwards.
+	   Returns false, if the slot couldn't be queued (the overflow policy RunInline is handled by the caller).
+	*/
+	bool invokeSlotQueued(SignalSlotConnection& connection, InvokeFunction pfnInvoke, ReleaseFunction pfnRelease, const void* pPayload, unsigned int uPayloadSize,
+	                      bool bFanOut = false);
+
+	// Calls the slots of the QueuedConnections of the signal with the priority (fan-out mode). It is called by the task, which processes the queued signals.
+	friend void invokeFanOut(SignalBase* pSignal, Priority priority, InvokeFunction pfnInvoke, const void* pPayload);
+
+};
+
+
+/* \class ScopedConnection
+   \brief Owns a connection, and removes it in its destructor
+
+   Typical usage is a member of the receiver, so the connection can't outlive the receiver object:
+   m_connection.reset(m_sensor.measurementReady, m_sensor.measurementReady.connect(this, &MyClass::onMeasurement, SignalBase::QueuedConnection));
+   The connection is removed in constant time (see SignalBase::disconnect(ConnectionHandle)), and nothing happens if it has already been removed.
+   Restrictions:
+   - it can't be copied (the ownership can be given up with release())
+   - the signal must exist, while the ScopedConnection has a connection
+   - a global ScopedConnection (or a global object with a ScopedConnection member) needs __cxa_atexit for its destructor, so it is meant
+     for objects, which are created and deleted at runtime
+   .
+*/
+class ScopedConnection
+{
+public:
+
+	/*! Constructor without connection.
+	*/
+	ScopedConnection() : m_pSignal(NULL), m_handle(-1) {}
+
+	/*! Constructor which takes the ownership of the connection handle of signal.
+	*/
+	ScopedConnection(SignalBase& signal, SignalBase::ConnectionHandle handle) : m_pSignal(&signal), m_handle(handle) {}
+
+	/*! Destructor, which removes the connection.
+	*/
+	~ScopedConnection() { disconnect(); }
+
+	/*! Removes the current connection, and takes the ownership of the connection handle of signal.
+	*/
+	void reset(SignalBase& signal, SignalBase::ConnectionHandle handle)
+	{
+		disconnect();
+		m_pSignal = &signal;
+		m_handle = handle;
+	}
+
+	/*! Removes the connection.
+	*/
+	void disconnect()
+	{
+		if (NULL != m_pSignal)
+		{
+			m_pSignal->disconnect(m_handle);
+			m_pSignal = NULL;
+			m_handle = -1;
+		}
+	}
+
+	/*! Gives up the ownership of the connection without removing it, and returns its handle.
+	*/
+	SignalBase::ConnectionHandle release()
+	{
+		SignalBase::ConnectionHandle handle = m_handle;
+		m_pSignal = NULL;
+		m_handle = -1;
+		return handle;
+	}
+
+	/*! Returns true, if the connection exists.
+	*/
+	bool isConnected() const { return NULL != m_pSignal && m_pSignal->isConnected(m_handle); }
+
+private:
+
+	// disable copy constructor
+	ScopedConnection(const ScopedConnection&);
+
+	// disable operator=
+	ScopedConnection& operator=(const ScopedConnection&);
+
+	SignalBase* m_pSignal;
+	SignalBase::ConnectionHandle m_handle;
+};
+
+
 /* \class Signal
    \brief Simple implementation of the signal slot pattern (based on FastDelegate)
    
    This class provides the signal-slot functionality for the ESP8266 platform.
    Features:
    - what you would except as signal-slot functionality: emitting a signal will result in calling the connected slot(s)
+   - slots can be member functions, free functions or lambdas without captures, and a connection can be single-shot (see connectOnce())
+   - connect() returns a handle, which removes the connection in constant time (see SignalBase::disconnect(ConnectionHandle) and ScopedConnection)
    - two types of signal-slot connections: 
      - DirectConnection: emitting the signal will call the slots as a direct function call from emit
      - QueuedConnection: calling the slot is decoupled from emitting the signal. The slot won't be called directly from emit. (This feature is important
        for the ESP8266 platform to let run the "background SW", which maintains WiFi connectivity; otherwise the watchdog might reset the chip)
+     - CoalescedConnection: like QueuedConnection, but at most one call is queued; a newer emit replaces the parameter of the queued call
      .
    - no dynamic heap management to store the signal-slot connections, or to store the queued signals
+   - connections, which are known at compile time, can be stored in flash (see SignalBase::StaticConnection and connectStatic())
+   - fan-out mode for signals with many queued connections: one queue entry per emit (see setFanOut())
+   - the parameter of emit() is owned by the signal, and it is freed after the last slot has been called (with os_free(), or if it
+     has been allocated from a MemoryPool, then it is returned to the pool)
    .
    Restrictions:
-   - each slot must have an input parameter void*, and can't have return value
-   - the number of simultaneous signal-slot connections is limited in MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS
-   - the number of queued signals is limited in MAX_NR_OF_QUEUED_SIGNALS
-   - the implementation is not interrupt-proof, so don't use the class directly from interrupt handler
+   - each slot must have an input parameter void*, and can't have return value (see TypedSignal and TypedSignal2..4 for other parameter types)
+   - the number of simultaneous signal-slot connections is limited in MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS (the cost of emit() depends only
+     on the number of connections of the emitted signal, and the cost of connect() and of queueing a slot doesn't depend on how many
+     entries are used)
+   - the number of queued signals is limited in MAX_NR_OF_QUEUED_SIGNALS (and for the higher priorities in MAX_NR_OF_QUEUED_SIGNALS_MEDIUM_PRIORITY
+     and MAX_NR_OF_QUEUED_SIGNALS_HIGH_PRIORITY)
+   - the implementation is not interrupt-proof, so the only function, which may be called from an interrupt handler is emitFromIsr()
    .
+   The library is written in C++03 (so there is a separate template for each number of parameters, see TypedSignalBase). Lambdas can
+   only be connected, if the application is compiled as C++11 or later.
 */
 
-class Signal
+class Signal : public SignalBase
 {
 public:
 	
-	enum ConnectionType
-	{
-		//! The slot will be directly called from emit()
-		DirectConnection,
-		
-		//! The slot won't be called from emit(). The slot will be called later, scheduled by the chip's scheduler
-		QueuedConnection
-	};
-	
 	// Delegate a function which takes void* and returns void
 	typedef FastDelegate1<void *> VoidFunction;
 
@@ -85,33 +673,22 @@ public:
 
 	
 	/*! Connects the signal to the receiverFunction slot of the object receiverObject
-	    The function returns an integer between 0 and MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS if succeeded, otherwise returns -1.
+	    The function returns the handle of the connection (a non-negative integer, see disconnect(ConnectionHandle)) if succeeded, otherwise returns -1.
 	    The error code -1 means that MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS is too small for the application.
 	    You cann connect one signal to the same receiverObject/receiverFunction multiple time -> then the slot will be invoked multiple times too.
+	    The priority is only relevant for QueuedConnection and CoalescedConnection.
 	 */
 	template < class X, class Y >
-    int connect(Y *receiverObject, void (X::* receiverFunction)(void*), ConnectionType connectionType)
+    int connect(Y *receiverObject, void (X::* receiverFunction)(void*), ConnectionType connectionType, Priority priority = LowPriority)
 	{
-		int iConnectionIndex = 0;
-		while (iConnectionIndex < MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS && s_listConnections[iConnectionIndex].m_Signal != 0)
-		{
-			++iConnectionIndex;
-		}
-
-		if (0 <= iConnectionIndex && iConnectionIndex < MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS)
-		{
-			s_listConnections[iConnectionIndex].m_Signal = this;
-			s_listConnections[iConnectionIndex].m_Slot.bind(receiverObject, receiverFunction);
-			s_listConnections[iConnectionIndex].m_Type = connectionType;
-		}
-		else
-		{
-			iConnectionIndex = -1;
-		}
-		return iConnectionIndex;
+		VoidFunction fcnt; fcnt.bind(receiverObject, receiverFunction);
+		return connectSlot(fcnt.GetMemento(), connectionType, priority);
 	}
 
 	
+	// disconnect(ConnectionHandle) of SignalBase
+	using SignalBase::disconnect;
+
 	/*! Disconnects the signal from the receiverFunction slot of the object receiverObject.
 	    If the signal was connected multiple times to receiverObject/receiverFunction, then all connections are removed.
 	    The return value is the number of disconnected signal-slots.
@@ -119,54 +696,436 @@ public:
 	template < class X, class Y >
 	int disconnect(Y *receiverObject, void (X::* receiverFunction)(void*))
 	{
-		int iNrOfDisconnects = 0;
 		VoidFunction fcnt; fcnt.bind(receiverObject, receiverFunction);
-		for (int i = 0; i < MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS; ++i)
-		{
-			if (s_listConnections[i].m_Signal == this &&
-			    s_listConnections[i].m_Slot == fcnt)
-			{
-				s_listConnections[i].m_Signal = 0;
-				++iNrOfDisconnects;
-			}
-		}
-		return iNrOfDisconnects;
+		return disconnectSlot(fcnt.GetMemento());
+	}
+
+	/*! Connects the signal to the free (or static member) function receiverFunction. A lambda without captures can be passed too,
+	    because it is converted to a function pointer. The return value is the same as for the member functions.
+	*/
+	int connect(void (*receiverFunction)(void*), ConnectionType connectionType, Priority priority = LowPriority)
+	{
+		VoidFunction fcnt; fcnt.bind(receiverFunction);
+		return connectSlot(fcnt.GetMemento(), connectionType, priority);
+	}
+
+	/*! Disconnects the signal from the free function receiverFunction. The return value is the same as for the member functions.
+	*/
+	int disconnect(void (*receiverFunction)(void*))
+	{
+		VoidFunction fcnt; fcnt.bind(receiverFunction);
+		return disconnectSlot(fcnt.GetMemento());
+	}
+
+	/*! Like connect(), but the connection is removed, when the slot is called the first time (for a QueuedConnection: when the call is queued).
+	    A single-shot connection is never coalesced, and it isn't part of the fan-out calls (see setFanOut()).
+	*/
+	template < class X, class Y >
+	int connectOnce(Y *receiverObject, void (X::* receiverFunction)(void*), ConnectionType connectionType, Priority priority = LowPriority)
+	{
+		VoidFunction fcnt; fcnt.bind(receiverObject, receiverFunction);
+		return connectSlot(fcnt.GetMemento(), connectionType, priority, true);
+	}
+
+	/*! Like connect(), but the connection is removed, when the free function receiverFunction is called the first time.
+	*/
+	int connectOnce(void (*receiverFunction)(void*), ConnectionType connectionType, Priority priority = LowPriority)
+	{
+		VoidFunction fcnt; fcnt.bind(receiverFunction);
+		return connectSlot(fcnt.GetMemento(), connectionType, priority, true);
+	}
+
+	/*! Creates the slot receiverFunction of a static connection (see SignalBase::StaticConnection) for the receiver object pReceiver.
+	*/
+	template < class X, void (X::* receiverFunction)(void*) >
+	static void staticSlot(void* pReceiver, DelegateMemento& slot)
+	{
+		VoidFunction fcnt; fcnt.bind(static_cast<X*>(pReceiver), receiverFunction);
+		slot = fcnt.GetMemento();
 	}
 
 	/*! Emits the signal with the parameter pParameter
 	*/
 	void emit(void* pParameter);
 
+
+	/*! Emits the signal from an interrupt handler.
+	    The signal is only stored in a lock-free queue, and emit(pParameter) will be called later from the task, which processes the queued signals.
+	    So all slots (even the ones with DirectConnection) are called outside of the interrupt handler.
+	    Returns false, if the queue is full (see MAX_NR_OF_SIGNALS_FROM_ISR). In this case the signal isn't emitted and pParameter isn't freed.
+	*/
+	bool emitFromIsr(void* pParameter);
+
 private:
+
+	// The payload of the slots: the parameter, and its index in the shared parameters (-1 if the parameter is not shared with queued slots)
+	struct Parameter
+	{
+		void* pParameter;
+		int iSharedParameter;
+	};
+
+	// Parameter must fit into the queue (the array size is negative otherwise, and the compilation fails)
+	typedef char ParameterMustFitIntoQueue[sizeof(Parameter) <= MAX_SIZE_OF_INLINE_PAYLOAD ? 1 : -1];
+
+	// Calls the slot with the parameter
+	static void invokeSlot(const DelegateMemento& slot, const void* pPayload);
+
+	// Releases the reference of a queued slot to the shared parameter
+	static void releaseQueuedParameter(const void* pPayload);
+
+	// Drops the oldest queued call, which holds the last reference to its shared parameter (see DropOldest). Returns false, if there is none.
+	static bool dropQueuedCallWithSharedParameter();
+
+};
+
+
+/* The slot types of the delegate Function (a FastDelegate1..4 without return value): the free functions, and the member functions of X
+*/
+template <class Function>
+struct SlotTypes;
+
+template <class T>
+struct SlotTypes< FastDelegate1<T> >
+{
+	typedef void (*FreeFunction)(T);
+	template <class X> struct MemberFunction { typedef void (X::* Type)(T); };
+};
+
+template <class T1, class T2>
+struct SlotTypes< FastDelegate2<T1, T2> >
+{
+	typedef void (*FreeFunction)(T1, T2);
+	template <class X> struct MemberFunction { typedef void (X::* Type)(T1, T2); };
+};
+
+template <class T1, class T2, class T3>
+struct SlotTypes< FastDelegate3<T1, T2, T3> >
+{
+	typedef void (*FreeFunction)(T1, T2, T3);
+	template <class X> struct MemberFunction { typedef void (X::* Type)(T1, T2, T3); };
+};
+
+template <class T1, class T2, class T3, class T4>
+struct SlotTypes< FastDelegate4<T1, T2, T3, T4> >
+{
+	typedef void (*FreeFunction)(T1, T2, T3, T4);
+	template <class X> struct MemberFunction { typedef void (X::* Type)(T1, T2, T3, T4); };
+};
+
+
+/* \class TypedSignalBase
+   \brief The connect and disconnect functions of TypedSignal and TypedSignal2..4, whose slots are bound with the delegate Function
+
+   Only emit() depends on the number of parameters, so the derived classes only add emit() and the call of a slot from the queue.
+*/
+template <class Function>
+class TypedSignalBase : public SignalBase
+{
+public:
+
+	// The type of the free function slots
+	typedef typename SlotTypes<Function>::FreeFunction FreeFunction;
+
+
+	/*! Connects the signal to the receiverFunction slot of the object receiverObject. The return value is the same as for Signal::connect().
+	    The slot must be a member function with the parameters of the signal (otherwise the compilation fails in FastDelegate::bind()).
+	 */
+	template < class Y, class MemberFunction >
+	int connect(Y *receiverObject, MemberFunction receiverFunction, ConnectionType connectionType, Priority priority = LowPriority)
+	{
+		Function fcnt; fcnt.bind(receiverObject, receiverFunction);
+		return connectSlot(fcnt.GetMemento(), connectionType, priority);
+	}
+
+
+	// disconnect(ConnectionHandle) of SignalBase
+	using SignalBase::disconnect;
+
+	/*! Disconnects the signal from the receiverFunction slot of the object receiverObject. The return value is the same as for Signal::disconnect().
+	*/
+	template < class Y, class MemberFunction >
+	int disconnect(Y *receiverObject, MemberFunction receiverFunction)
+	{
+		Function fcnt; fcnt.bind(receiverObject, receiverFunction);
+		return disconnectSlot(fcnt.GetMemento());
+	}
+
+	/*! Connects the signal to the free function (or lambda without captures) receiverFunction, see Signal::connect().
+	*/
+	int connect(FreeFunction receiverFunction, ConnectionType connectionType, Priority priority = LowPriority)
+	{
+		Function fcnt; fcnt.bind(receiverFunction);
+		return connectSlot(fcnt.GetMemento(), connectionType, priority);
+	}
+
+	/*! Disconnects the signal from the free function receiverFunction, see Signal::disconnect().
+	*/
+	int disconnect(FreeFunction receiverFunction)
+	{
+		Function fcnt; fcnt.bind(receiverFunction);
+		return disconnectSlot(fcnt.GetMemento());
+	}
+
+	/*! Single-shot connection to the receiverFunction slot of the object receiverObject, see Signal::connectOnce().
+	*/
+	template < class Y, class MemberFunction >
+	int connectOnce(Y *receiverObject, MemberFunction receiverFunction, ConnectionType connectionType, Priority priority = LowPriority)
+	{
+		Function fcnt; fcnt.bind(receiverObject, receiverFunction);
+		return connectSlot(fcnt.GetMemento(), connectionType, priority, true);
+	}
+
+	/*! Single-shot connection to the free function receiverFunction, see Signal::connectOnce().
+	*/
+	int connectOnce(FreeFunction receiverFunction, ConnectionType connectionType, Priority priority = LowPriority)
+	{
+		Function fcnt; fcnt.bind(receiverFunction);
+		return connectSlot(fcnt.GetMemento(), connectionType, priority, true);
+	}
+
+	/*! Creates the slot receiverFunction of a static connection (see SignalBase::StaticConnection) for the receiver object pReceiver.
+	*/
+	template < class X, typename SlotTypes<Function>::template MemberFunction<X>::Type receiverFunction >
+	static void staticSlot(void* pReceiver, DelegateMemento& slot)
+	{
+		Function fcnt; fcnt.bind(static_cast<X*>(pReceiver), receiverFunction);
+		slot = fcnt.GetMemento();
+	}
+
+protected:
+
+	TypedSignalBase() {}
+
+	TypedSignalBase(const char* strSignalName) : SignalBase(strSignalName) {}
+
+};
+
+
+/* \class TypedSignal
+   \brief Signal with a parameter of type T, which is passed by value to the slots
+   
+   Unlike Signal, the parameter isn't a pointer to a heap allocated object: the parameter of the slots with QueuedConnection is copied into the queue.
+   So emitting a TypedSignal doesn't need any dynamic heap management.
+   Restrictions:
+   - each slot must have an input parameter T, and can't have return value
+   - T must be trivially copyable (it is copied with os_memcpy), and sizeof(T) can't be bigger than MAX_SIZE_OF_INLINE_PAYLOAD
+   - the same restrictions as for Signal
+   .
+*/
+template <class T>
+class TypedSignal : public TypedSignalBase< FastDelegate1<T> >
+{
+public:
 	
-	// disable copy constructor
-	Signal(const Signal&);
+	// Delegate a function which takes T and returns void
+	typedef FastDelegate1<T> Function;
+
 	
-	// disable operator=
-	Signal& operator=(const Signal&);
+	/*! Default constructor.
+	*/
+	TypedSignal() {}
+
+	
+	/*! Constructor which prints the this pointer and the name of the signal.
+    */
+	TypedSignal(const char* strSignalName) : TypedSignalBase<Function>(strSignalName) {}
+
 	
+	/*! Emits the signal with the parameter value
+	*/
+	void emit(T value)
+	{
+		Trace::record(Trace::SignalEmit, this);
+		this->dispatch(&value, sizeof(T), &invokeSlot, &invokeSlot, NULL);
+	}
 
-	struct SignalSlotConnection
+private:
+
+	// T must fit into the queue (the array size is negative otherwise, and the compilation fails)
+	typedef char ParameterMustFitIntoQueue[sizeof(T) <= MAX_SIZE_OF_INLINE_PAYLOAD ? 1 : -1];
+
+	// Calls the slot with the parameter stored in pPayload
+	static void invokeSlot(const DelegateMemento& slot, const void* pPayload)
+	{
+		Function fcnt; fcnt.SetMemento(slot);
+		fcnt(*static_cast<const T*>(pPayload));
+	}
+
+};
+
+/* \class TypedSignal2
+   \brief Signal with 2 parameters, which are passed by value to the slots
+
+   The same as TypedSignal, but the slots have 2 parameters. The arguments of a queued slot are stored together in the queue,
+   so there is no need to pack them into a heap allocated struct.
+   Restrictions:
+   - the sum of the sizes of the parameters (with alignment) can't be bigger than MAX_SIZE_OF_INLINE_PAYLOAD
+   - the same restrictions as for TypedSignal
+   .
+*/
+template <class T1, class T2>
+class TypedSignal2 : public TypedSignalBase< FastDelegate2<T1, T2> >
+{
+public:
+
+	// Delegate a function which takes T1, T2 and returns void
+	typedef FastDelegate2<T1, T2> Function;
+
+
+	/*! Default constructor.
+	*/
+	TypedSignal2() {}
+
+
+	/*! Constructor which prints the this pointer and the name of the signal.
+    */
+	TypedSignal2(const char* strSignalName) : TypedSignalBase<Function>(strSignalName) {}
+
+
+	/*! Emits the signal with the parameters
+	*/
+	void emit(T1 value1, T2 value2)
+	{
+		Trace::record(Trace::SignalEmit, this);
+		Arguments arguments = { value1, value2 };
+		this->dispatch(&arguments, sizeof(Arguments), &invokeSlot, &invokeSlot, NULL);
+	}
+
+private:
+
+	// The payload of the slots
+	struct Arguments
 	{
-		SignalSlotConnection() : m_Signal(0) {  }
-		Signal* m_Signal;
-		VoidFunction m_Slot;
-		ConnectionType m_Type;
+		T1 value1;
+		T2 value2;
 	};
 
+	// The arguments must fit into the queue (the array size is negative otherwise, and the compilation fails)
+	typedef char ParametersMustFitIntoQueue[sizeof(Arguments) <= MAX_SIZE_OF_INLINE_PAYLOAD ? 1 : -1];
 
-	// List of all signal-slot connections
-	static SignalSlotConnection s_listConnections[MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS];
+	// Calls the slot with the parameters stored in pPayload
+	static void invokeSlot(const DelegateMemento& slot, const void* pPayload)
+	{
+		const Arguments* pArguments = static_cast<const Arguments*>(pPayload);
+		Function fcnt; fcnt.SetMemento(slot);
+		fcnt(pArguments->value1, pArguments->value2);
+	}
+
+};
 
-	// Is the task which handles queued signals already started?
-	static bool s_bTaskInvokeSlotIsStarted;
+/* \class TypedSignal3
+   \brief Signal with 3 parameters, which are passed by value to the slots
 
-	// Starts an internal task, which is processing the queued signals
-	bool startInvokeTask();
+   The same as TypedSignal2, but the slots have 3 parameters. With the default MAX_SIZE_OF_INLINE_PAYLOAD (8 bytes) the parameters can
+   only be small types (e.g. uint8, uint16 and uint32): for bigger ones MAX_SIZE_OF_INLINE_PAYLOAD must be increased.
+*/
+template <class T1, class T2, class T3>
+class TypedSignal3 : public TypedSignalBase< FastDelegate3<T1, T2, T3> >
+{
+public:
 
-	// Sends an event to taskInvokeSlot to call a slot
-	bool invokeSlotQueued(FastDelegate1<void*> functionSlot, void* pParameter);
+	// Delegate a function which takes T1, T2, T3 and returns void
+	typedef FastDelegate3<T1, T2, T3> Function;
+
+
+	/*! Default constructor.
+	*/
+	TypedSignal3() {}
+
+
+	/*! Constructor which prints the this pointer and the name of the signal.
+    */
+	TypedSignal3(const char* strSignalName) : TypedSignalBase<Function>(strSignalName) {}
+
+
+	/*! Emits the signal with the parameters
+	*/
+	void emit(T1 value1, T2 value2, T3 value3)
+	{
+		Trace::record(Trace::SignalEmit, this);
+		Arguments arguments = { value1, value2, value3 };
+		this->dispatch(&arguments, sizeof(Arguments), &invokeSlot, &invokeSlot, NULL);
+	}
+
+private:
+
+	// The payload of the slots
+	struct Arguments
+	{
+		T1 value1;
+		T2 value2;
+		T3 value3;
+	};
+
+	// The arguments must fit into the queue (the array size is negative otherwise, and the compilation fails)
+	typedef char ParametersMustFitIntoQueue[sizeof(Arguments) <= MAX_SIZE_OF_INLINE_PAYLOAD ? 1 : -1];
+
+	// Calls the slot with the parameters stored in pPayload
+	static void invokeSlot(const DelegateMemento& slot, const void* pPayload)
+	{
+		const Arguments* pArguments = static_cast<const Arguments*>(pPayload);
+		Function fcnt; fcnt.SetMemento(slot);
+		fcnt(pArguments->value1, pArguments->value2, pArguments->value3);
+	}
 
+};
+
+/* \class TypedSignal4
+   \brief Signal with 4 parameters, which are passed by value to the slots
+
+   The same as TypedSignal2, but the slots have 4 parameters. With the default MAX_SIZE_OF_INLINE_PAYLOAD (8 bytes) the parameters can
+   only be small types (e.g. 4 times uint8, or 2 times uint16): for bigger ones MAX_SIZE_OF_INLINE_PAYLOAD must be increased.
+*/
+template <class T1, class T2, class T3, class T4>
+class TypedSignal4 : public TypedSignalBase< FastDelegate4<T1, T2, T3, T4> >
+{
+public:
+
+	// Delegate a function which takes T1, T2, T3, T4 and returns void
+	typedef FastDelegate4<T1, T2, T3, T4> Function;
+
+
+	/*! Default constructor.
+	*/
+	TypedSignal4() {}
+
+
+	/*! Constructor which prints the this pointer and the name of the signal.
+    */
+	TypedSignal4(const char* strSignalName) : TypedSignalBase<Function>(strSignalName) {}
+
+
+	/*! Emits the signal with the parameters
+	*/
+	void emit(T1 value1, T2 value2, T3 value3, T4 value4)
+	{
+		Trace::record(Trace::SignalEmit, this);
+		Arguments arguments = { value1, value2, value3, value4 };
+		this->dispatch(&arguments, sizeof(Arguments), &invokeSlot, &invokeSlot, NULL);
+	}
+
+private:
+
+	// The payload of the slots
+	struct Arguments
+	{
+		T1 value1;
+		T2 value2;
+		T3 value3;
+		T4 value4;
+	};
+
+	// The arguments must fit into the queue (the array size is negative otherwise, and the compilation fails)
+	typedef char ParametersMustFitIntoQueue[sizeof(Arguments) <= MAX_SIZE_OF_INLINE_PAYLOAD ? 1 : -1];
+
+	// Calls the slot with the parameters stored in pPayload
+	static void invokeSlot(const DelegateMemento& slot, const void* pPayload)
+	{
+		const Arguments* pArguments = static_cast<const Arguments*>(pPayload);
+		Function fcnt; fcnt.SetMemento(slot);
+		fcnt(pArguments->value1, pArguments->value2, pArguments->value3, pArguments->value4);
+	}
 
 };
 
@@ -1,31 +1,729 @@
 #include "Timer.h"
+#include "debug.h"
+
+extern "C" {
+  #include <user_interface.h>
+}
 
 using namespace Esp8266Base;
 
-void ICACHE_FLASH_ATTR global_timer_callback(void * args)
+
+namespace Esp8266Base
+{
+
+/* A pending call of Timer::singleShot(). The records are allocated from g_poolSingleShotTimers, and the pending ones are linked in a list,
+   so that cancelSingleShots() can find them.
+*/
+class SingleShotTimer
 {
-	if (args != NULL)
+public:
+
+	ICACHE_FLASH_ATTR SingleShotTimer(const DelegateMemento& slot);
+
+	static void* ICACHE_FLASH_ATTR operator new(size_t size) throw();
+
+	static void ICACHE_FLASH_ATTR operator delete(void* p);
+
+	// Arms the os_timer, and links the record into the list of the pending calls
+	void ICACHE_FLASH_ATTR start(int ms);
+
+	// Disarms the os_timer, unlinks the record, and returns it to the pool
+	void ICACHE_FLASH_ATTR release();
+
+	// Callback of the os_timer: releases the record, and calls the slot
+	static void ICACHE_FLASH_ATTR osTimerCallback(void* pSingleShotTimer);
+
+	static SingleShotTimer* s_pFirstPending;
+
+	SingleShotTimer* m_pNext;
+	os_timer_t m_osTimer;
+	DelegateMemento m_slot;
+};
+
+}
+
+MemoryPool<sizeof(SingleShotTimer), NR_OF_SINGLE_SHOT_TIMERS> g_poolSingleShotTimers;
+
+SingleShotTimer* SingleShotTimer::s_pFirstPending = NULL;
+
+
+ICACHE_FLASH_ATTR SingleShotTimer::SingleShotTimer(const DelegateMemento& slot) : m_pNext(NULL), m_slot(slot)
+{
+}
+
+
+void* ICACHE_FLASH_ATTR SingleShotTimer::operator new(size_t size) throw()
+{
+	void* p = g_poolSingleShotTimers.allocate();
+	if (NULL == p)
 	{
-		Timer* p = (Timer*)args;
-		p->timeOut.emit(NULL);
-		if (p->getUserSignal() != NULL)
+		printError("ERROR: Timer::singleShot() failed. NR_OF_SINGLE_SHOT_TIMERS too small?\n");
+	}
+	return p;
+}
+
+
+void ICACHE_FLASH_ATTR SingleShotTimer::operator delete(void* p)
+{
+	g_poolSingleShotTimers.release(p);
+}
+
+
+void ICACHE_FLASH_ATTR SingleShotTimer::start(int ms)
+{
+	m_pNext = s_pFirstPending;
+	s_pFirstPending = this;
+	os_timer_disarm(&m_osTimer);
+	os_timer_setfn(&m_osTimer, osTimerCallback, this);
+	os_timer_arm(&m_osTimer, ms > 0 ? ms : 0, false);
+}
+
+
+void ICACHE_FLASH_ATTR SingleShotTimer::release()
+{
+	os_timer_disarm(&m_osTimer);
+	SingleShotTimer** ppLink = &s_pFirstPending;
+	while (NULL != *ppLink && this != *ppLink)
+	{
+		ppLink = &(*ppLink)->m_pNext;
+	}
+	if (NULL != *ppLink)
+	{
+		*ppLink = m_pNext;
+	}
+	delete this;
+}
+
+
+void ICACHE_FLASH_ATTR SingleShotTimer::osTimerCallback(void* pSingleShotTimer)
+{
+	SingleShotTimer* pRecord = static_cast<SingleShotTimer*>(pSingleShotTimer);
+	Signal::VoidFunction fcnt; fcnt.SetMemento(pRecord->m_slot);
+	Trace::record(Trace::TimerExpired, pRecord, 0);
+	pRecord->release();
+	fcnt(NULL);
+}
+
+
+bool ICACHE_FLASH_ATTR Timer::startSingleShot(int ms, const DelegateMemento& slot)
+{
+	SingleShotTimer* pRecord = new SingleShotTimer(slot);
+	if (NULL != pRecord)
+	{
+		pRecord->start(ms);
+	}
+	return NULL != pRecord;
+}
+
+
+int ICACHE_FLASH_ATTR Timer::cancelSingleShotSlot(const DelegateMemento& slot)
+{
+	int nRet = 0;
+	SingleShotTimer* pRecord = SingleShotTimer::s_pFirstPending;
+	while (NULL != pRecord)
+	{
+		SingleShotTimer* pNext = pRecord->m_pNext;
+		if (pRecord->m_slot.IsEqual(slot))
 		{
-			p->getUserSignal()->emit(NULL);
+			pRecord->release();
+			++nRet;
 		}
+		pRecord = pNext;
 	}
+	return nRet;
 }
 
 
-void ICACHE_FLASH_ATTR Timer::start(int ms, bool bRepeat, Signal* pSignal)
+const MemoryPoolBase& ICACHE_FLASH_ATTR Timer::getSingleShotPool()
+{
+	return g_poolSingleShotTimers;
+}
+
+
+uint32 Timer::s_uLastSystemTime = 0;
+uint32 Timer::s_uNrOfSystemTimeOverflows = 0;
+
+
+uint64 ICACHE_FLASH_ATTR Timer::getTime()
+{
+	uint32 uSystemTime = system_get_time();
+	if (uSystemTime < s_uLastSystemTime)
+	{
+		++s_uNrOfSystemTimeOverflows;
+	}
+	s_uLastSystemTime = uSystemTime;
+	return ((uint64)s_uNrOfSystemTimeOverflows << 32) | uSystemTime;
+}
+
+
+void ICACHE_FLASH_ATTR Timer::expire(uint32 uNrOfSkippedPeriods)
+{
+	uint64 uNow = getTime();
+	// the lower 32 bits are enough for the jitter (even if an overflow of system_get_time() hasn't been seen by a long start() timer)
+	m_iLastJitterUs = (sint32)((uint32)uNow - (uint32)m_uDeadline);
+	uint32 uJitter = (m_iLastJitterUs < 0) ? -m_iLastJitterUs : m_iLastJitterUs;
+	if (uJitter > m_uMaxJitterUs)
+	{
+		m_uMaxJitterUs = uJitter;
+	}
+	m_uDeadline += (1 + (uint64)uNrOfSkippedPeriods) * m_uPeriodUs;
+
+#if !TIMER_WHEEL
+	if (m_bAbsoluteDeadlines && m_uPeriodUs > 0)
+	{
+		// re-armed before the slots are called, so that their runtime doesn't delay the next period
+		if (m_uDeadline <= uNow)
+		{
+			if (CatchUpMissedPeriods == m_OverrunPolicy)
+			{
+				// the deadline stays, so the timer expires again immediately
+				++m_uNrOfOverruns;
+			}
+			else
+			{
+				uint32 uNrOfMissedPeriods = (uint32)((uNow - m_uDeadline) / m_uPeriodUs + 1);
+				m_uDeadline += uNrOfMissedPeriods * m_uPeriodUs;
+				m_uNrOfOverruns += uNrOfMissedPeriods;
+			}
+		}
+		armForDeadline();
+	}
+#endif
+
+	Trace::record(Trace::TimerExpired, this, m_iLastJitterUs);
+	timeOut.emit(NULL);
+	if (m_pSignal != NULL)
+	{
+		m_pSignal->emit(NULL);
+	}
+}
+
+
+void ICACHE_FLASH_ATTR Timer::osTimerCallback(void* pTimer)
+{
+	if (pTimer != NULL)
+	{
+#if !TIMER_WHEEL
+		if (static_cast<Timer*>(pTimer)->m_bAbsoluteDeadlines)
+		{
+			expireTimersWithDeadline(static_cast<Timer*>(pTimer));
+		}
+		else
+#endif
+		{
+			static_cast<Timer*>(pTimer)->expire();
+		}
+	}
+}
+
+
+void ICACHE_FLASH_ATTR Timer::link(Timer** ppLink, Timer* pTimer)
+{
+	pTimer->m_pNext = *ppLink;
+	if (NULL != pTimer->m_pNext)
+	{
+		pTimer->m_pNext->m_ppLink = &pTimer->m_pNext;
+	}
+	pTimer->m_ppLink = ppLink;
+	*ppLink = pTimer;
+}
+
+
+void ICACHE_FLASH_ATTR Timer::unlink(Timer* pTimer)
+{
+	if (NULL != pTimer->m_ppLink)
+	{
+		*pTimer->m_ppLink = pTimer->m_pNext;
+		if (NULL != pTimer->m_pNext)
+		{
+			pTimer->m_pNext->m_ppLink = pTimer->m_ppLink;
+		}
+		pTimer->m_ppLink = NULL;
+	}
+}
+
+
+void ICACHE_FLASH_ATTR Timer::armOsTimer(uint32 uTime, bool bRepeat, bool bMicroseconds)
 {
-	m_pSignal = pSignal;
 	os_timer_disarm(&m_osTimer);
-	os_timer_setfn(&m_osTimer, global_timer_callback, this);
-	os_timer_arm(&m_osTimer, ms, bRepeat);
+	os_timer_setfn(&m_osTimer, osTimerCallback, this);
+#ifdef USE_US_TIMER
+	if (bMicroseconds)
+	{
+		os_timer_arm_us(&m_osTimer, uTime, bRepeat);
+	}
+	else
+#endif
+	{
+		os_timer_arm(&m_osTimer, uTime, bRepeat);
+	}
+}
+
+
+// The longest delay, for which an os_timer is armed at once (the maximum of os_timer_arm_us()). A longer wait is split into more os_timer
+// runs, so getTime() is also called often enough.
+#define MAX_OS_TIMER_DELAY_US 0xFFFFFFF
+
+#if TIMER_WHEEL
+
+// The number of buckets must be a power of two (the array size is negative otherwise, and the compilation fails)
+typedef char TimerWheelSizeMustBePowerOfTwo[(TIMER_WHEEL_SIZE >= 2 && (TIMER_WHEEL_SIZE & (TIMER_WHEEL_SIZE - 1)) == 0) ? 1 : -1];
+
+#define TIMER_WHEEL_TICK_US (TIMER_WHEEL_TICK_MS * 1000)
+
+// The longest sleep of the wheel in ticks (the limit of the os_timer): the elapsed time since the last processed tick fits into 32 bits
+#define TIMER_WHEEL_MAX_SLEEP_TICKS (MAX_OS_TIMER_DELAY_US / TIMER_WHEEL_TICK_US)
+
+
+namespace Esp8266Base
+{
+
+/* The timer wheel: a running Timer is stored in the bucket (m_uExpiryTick % TIMER_WHEEL_SIZE), so starting and stopping a timer only
+   links or unlinks it. The shared os_timer is armed for the next tick, in which a timer expires (a bucket might contain only timers of
+   later turns, they don't wake the wheel up). When it expires, the buckets of all
+   elapsed ticks are processed: the expired timers are moved to a list, and their signals are emitted one after the other.
+   The ticks are counted from system_get_time(), so a late os_timer callback doesn't shift the later expiries.
+*/
+class TimerWheel
+{
+public:
+
+	// Links the timer into the bucket of the first tick after its deadline (or up to uSlackTicks later)
+	static void ICACHE_FLASH_ATTR add(Timer* pTimer, uint32 uSlackTicks);
+
+	// Returns the current tick (including the elapsed ticks, which haven't been processed yet)
+	static uint32 ICACHE_FLASH_ATTR getCurrentTick();
+
+private:
+
+	// Returns the first tick, which starts at uTime (Timer::getTime()) or later (s_uTick, if uTime isn't after the last processed tick)
+	static uint32 ICACHE_FLASH_ATTR getTickOf(uint64 uTime);
+
+	// Links the timer into the bucket of its due tick, or of a later tick in its slack window, in which the wheel wakes up anyway
+	static void ICACHE_FLASH_ATTR schedule(Timer* pTimer, uint32 uDueTick);
+
+	// Returns true, if a timer expires in the tick uTick (then the wheel wakes up in it anyway)
+	static bool ICACHE_FLASH_ATTR isExpiryTick(uint32 uTick);
+
+	// Arms the shared os_timer for the tick uTick (or for an earlier one, if uTick is more than TIMER_WHEEL_MAX_SLEEP_TICKS away)
+	static void ICACHE_FLASH_ATTR armWakeUp(uint32 uTick);
+
+	// Arms the shared os_timer for the next tick, in which a timer expires. Returns false, if all buckets are empty.
+	static bool ICACHE_FLASH_ATTR armNextWakeUp();
+
+	// Callback of the shared os_timer
+	static void ICACHE_FLASH_ATTR processTicks(void*);
+
+	static Timer* s_arrayBuckets[TIMER_WHEEL_SIZE];
+
+	// Timers, which have expired, but whose signals haven't been emitted yet
+	static Timer* s_pFirstExpired;
+
+	// The last processed tick, and its start time (Timer::getTime())
+	static uint32 s_uTick;
+	static uint64 s_uTickTime;
+
+	// The shared os_timer, and the tick it is armed for
+	static os_timer_t s_osTimer;
+	static bool s_bArmed;
+	static uint32 s_uWakeUpTick;
+};
+
+Timer* TimerWheel::s_arrayBuckets[TIMER_WHEEL_SIZE];
+Timer* TimerWheel::s_pFirstExpired = NULL;
+uint32 TimerWheel::s_uTick = 0;
+uint64 TimerWheel::s_uTickTime = 0;
+os_timer_t TimerWheel::s_osTimer;
+bool TimerWheel::s_bArmed = false;
+uint32 TimerWheel::s_uWakeUpTick = 0;
+
+
+uint32 ICACHE_FLASH_ATTR TimerWheel::getCurrentTick()
+{
+	// the wheel never sleeps longer than TIMER_WHEEL_MAX_SLEEP_TICKS, so the elapsed time fits into 32 bits
+	return s_uTick + (uint32)(Timer::getTime() - s_uTickTime) / TIMER_WHEEL_TICK_US;
+}
+
+
+uint32 ICACHE_FLASH_ATTR TimerWheel::getTickOf(uint64 uTime)
+{
+	return (uTime > s_uTickTime) ? s_uTick + (uint32)((uTime - s_uTickTime + TIMER_WHEEL_TICK_US - 1) / TIMER_WHEEL_TICK_US) : s_uTick;
+}
+
+
+void ICACHE_FLASH_ATTR TimerWheel::schedule(Timer* pTimer, uint32 uDueTick)
+{
+	uint32 uExpiryTick = uDueTick + pTimer->m_uSlackTicks;
+	if (s_bArmed && s_uWakeUpTick - uDueTick <= pTimer->m_uSlackTicks)
+	{
+		uExpiryTick = s_uWakeUpTick;
+	}
+	for (uint32 uTick = uDueTick; uTick - uDueTick < pTimer->m_uSlackTicks && uTick - uDueTick < TIMER_WHEEL_SIZE
+	                              && (sint32)(uTick - uExpiryTick) < 0; ++uTick)
+	{
+		if (isExpiryTick(uTick))
+		{
+			uExpiryTick = uTick;
+		}
+	}
+	pTimer->m_uDueTick = uDueTick;
+	pTimer->m_uExpiryTick = uExpiryTick;
+	Timer::link(&s_arrayBuckets[uExpiryTick & (TIMER_WHEEL_SIZE - 1)], pTimer);
+}
+
+
+void ICACHE_FLASH_ATTR TimerWheel::add(Timer* pTimer, uint32 uSlackTicks)
+{
+	if (!s_bArmed)
+	{
+		// the wheel is idle: the ticks are counted from now
+		os_timer_setfn(&s_osTimer, processTicks, NULL);
+		s_uTickTime = Timer::getTime();
+	}
+
+	// the current tick has already started, so the timer can expire in the next tick at the earliest
+	uint32 uDueTick = getTickOf(pTimer->m_uDeadline);
+	uint32 uCurrentTick = getCurrentTick();
+	if ((sint32)(uDueTick - uCurrentTick) <= 0)
+	{
+		uDueTick = uCurrentTick + 1;
+	}
+	pTimer->m_uSlackTicks = uSlackTicks;
+	schedule(pTimer, uDueTick);
+
+	if (!s_bArmed || (sint32)(pTimer->m_uExpiryTick - s_uWakeUpTick) < 0)
+	{
+		armWakeUp(pTimer->m_uExpiryTick);
+	}
+}
+
+
+bool ICACHE_FLASH_ATTR TimerWheel::isExpiryTick(uint32 uTick)
+{
+	Timer* pTimer = s_arrayBuckets[uTick & (TIMER_WHEEL_SIZE - 1)];
+	while (NULL != pTimer && pTimer->m_uExpiryTick != uTick)
+	{
+		pTimer = pTimer->m_pNext;
+	}
+	return NULL != pTimer;
+}
+
+
+void ICACHE_FLASH_ATTR TimerWheel::armWakeUp(uint32 uTick)
+{
+	if (uTick - s_uTick > TIMER_WHEEL_MAX_SLEEP_TICKS)
+	{
+		// the wheel wakes up in between, and finds no expired timer
+		uTick = s_uTick + TIMER_WHEEL_MAX_SLEEP_TICKS;
+	}
+
+	// the os_timer is rounded up to milliseconds, so it never expires before the tick has started. The tick might have already started,
+	// if the slots of the expired timers were running long.
+	sint32 iDelayUs = (sint32)((uTick - s_uTick) * TIMER_WHEEL_TICK_US - (uint32)(Timer::getTime() - s_uTickTime));
+	if (iDelayUs < 0)
+	{
+		iDelayUs = 0;
+	}
+	os_timer_disarm(&s_osTimer);
+	os_timer_arm(&s_osTimer, (iDelayUs + 999) / 1000, false);
+	s_bArmed = true;
+	s_uWakeUpTick = uTick;
+}
+
+
+bool ICACHE_FLASH_ATTR TimerWheel::armNextWakeUp()
+{
+	// each timer expires after s_uTick, so the bucket of the tick uTick contains only timers of the tick uTick or of later turns: the
+	// first tick, in which a timer expires, is the earliest one. If there is none in this turn, the earliest expiry of all timers is used.
+	bool bRet = false;
+	uint32 uWakeUpTick = 0;
+	for (uint32 uTick = s_uTick + 1; uTick != s_uTick + 1 + TIMER_WHEEL_SIZE && !(bRet && uWakeUpTick == uTick - 1); ++uTick)
+	{
+		for (Timer* pTimer = s_arrayBuckets[uTick & (TIMER_WHEEL_SIZE - 1)]; NULL != pTimer; pTimer = pTimer->m_pNext)
+		{
+			if (!bRet || (sint32)(pTimer->m_uExpiryTick - uWakeUpTick) < 0)
+			{
+				uWakeUpTick = pTimer->m_uExpiryTick;
+				bRet = true;
+			}
+		}
+	}
+	if (bRet)
+	{
+		armWakeUp(uWakeUpTick);
+	}
+	return bRet;
+}
+
+
+void ICACHE_FLASH_ATTR TimerWheel::processTicks(void*)
+{
+	uint32 uNrOfTicks = (uint32)(Timer::getTime() - s_uTickTime) / TIMER_WHEEL_TICK_US;
+	uint32 uFirstTick = s_uTick + 1;
+	s_uTick += uNrOfTicks;
+	s_uTickTime += uNrOfTicks * TIMER_WHEEL_TICK_US;
+
+	// each bucket is processed at most once, even if the callback is late by more than one turn of the wheel
+	Timer** ppLastExpired = &s_pFirstExpired;
+	while (NULL != *ppLastExpired)
+	{
+		ppLastExpired = &(*ppLastExpired)->m_pNext;
+	}
+	for (uint32 i = 0; i < uNrOfTicks && i < TIMER_WHEEL_SIZE; ++i)
+	{
+		Timer* pTimer = s_arrayBuckets[(uFirstTick + i) & (TIMER_WHEEL_SIZE - 1)];
+		while (NULL != pTimer)
+		{
+			Timer* pNext = pTimer->m_pNext;
+			if ((sint32)(pTimer->m_uExpiryTick - s_uTick) <= 0)
+			{
+				// appended, so that the timers expire in the order of their ticks
+				Timer::unlink(pTimer);
+				Timer::link(ppLastExpired, pTimer);
+				ppLastExpired = &pTimer->m_pNext;
+			}
+			pTimer = pNext;
+		}
+	}
+
+	// the slots might start and stop timers (even the expired ones), so each timer is unlinked before its signals are emitted
+	while (NULL != s_pFirstExpired)
+	{
+		Timer* pTimer = s_pFirstExpired;
+		Timer::unlink(pTimer);
+		uint32 uNrOfSkippedPeriods = 0;
+		if (pTimer->m_uPeriodUs > 0)
+		{
+			// the next deadline is counted from the previous one in microseconds, not from now (or from a tick), so neither a late callback
+			// nor the rounding to ticks causes drift
+			uint64 uDeadline = pTimer->m_uDeadline + pTimer->m_uPeriodUs;
+			uint32 uDueTick = getTickOf(uDeadline);
+			if ((sint32)(uDueTick - s_uTick) > 0)
+			{
+				schedule(pTimer, uDueTick);
+			}
+			else if (Timer::CatchUpMissedPeriods == pTimer->m_OverrunPolicy)
+			{
+				// the timer expires again in this run (appended, so that the other expired timers come first)
+				++pTimer->m_uNrOfOverruns;
+				pTimer->m_uDueTick = s_uTick;
+				pTimer->m_uExpiryTick = s_uTick;
+				ppLastExpired = &s_pFirstExpired;
+				while (NULL != *ppLastExpired)
+				{
+					ppLastExpired = &(*ppLastExpired)->m_pNext;
+				}
+				Timer::link(ppLastExpired, pTimer);
+			}
+			else
+			{
+				// the missed periods are skipped: the next deadline is the first one after the start of the current tick
+				// (the deadline is moved by expire(), after the jitter has been measured)
+				uNrOfSkippedPeriods = (uint32)((s_uTickTime - uDeadline) / pTimer->m_uPeriodUs + 1);
+				pTimer->m_uNrOfOverruns += uNrOfSkippedPeriods;
+				schedule(pTimer, getTickOf(uDeadline + uNrOfSkippedPeriods * pTimer->m_uPeriodUs));
+			}
+		}
+		pTimer->expire(uNrOfSkippedPeriods);
+	}
+
+	// s_bArmed has been kept true until now, so that the timers started by the slots didn't re-arm the os_timer (or restart the ticks)
+	s_bArmed = false;
+	armNextWakeUp();
+}
+
+}
+
+
+Timer::Timer() : m_pNext(NULL), m_ppLink(NULL), m_uExpiryTick(0), m_uDueTick(0), m_uSlackTicks(0), m_bOwnOsTimer(false),
+                 m_pSignal(NULL), m_uDeadline(0), m_uPeriodUs(0), m_iLastJitterUs(0), m_uMaxJitterUs(0), m_uNrOfOverruns(0),
+                 m_OverrunPolicy(SkipMissedPeriods)
+{
+}
+
+
+void ICACHE_FLASH_ATTR Timer::start(int ms, bool bRepeat, Signal* pSignal, int slackMs)
+{
+	stop();
+	m_pSignal = pSignal;
+	m_uDeadline = getTime() + (uint64)(ms > 0 ? ms : 0) * 1000;
+
+	// a period shorter than a tick expires once per tick (the other periods are skipped)
+	m_uPeriodUs = bRepeat ? (uint64)(ms > 0 ? ms : 1) * 1000 : 0;
+	m_OverrunPolicy = SkipMissedPeriods;
+	TimerWheel::add(this, slackMs > 0 ? slackMs / TIMER_WHEEL_TICK_MS : 0);
+}
+
+
+void ICACHE_FLASH_ATTR Timer::startPeriodic(int ms, OverrunPolicy policy, Signal* pSignal, int slackMs)
+{
+	// the wheel computes each deadline of a repeating timer from the previous one
+	start(ms, true, pSignal, slackMs);
+	m_OverrunPolicy = policy;
+}
+
+
+#ifdef USE_US_TIMER
+void ICACHE_FLASH_ATTR Timer::startUs(uint32 us, bool bRepeat, Signal* pSignal)
+{
+	stop();
+	m_pSignal = pSignal;
+	m_uDeadline = getTime() + us;
+	m_uPeriodUs = bRepeat ? us : 0;
+	m_bOwnOsTimer = true;
+	armOsTimer(us, bRepeat, true);
+}
+#endif
+
+
+void ICACHE_FLASH_ATTR Timer::stop()
+{
+	// the shared os_timer stays armed: if it doesn't find an expired timer, it only looks for the next bucket
+	unlink(this);
+	if (m_bOwnOsTimer)
+	{
+		os_timer_disarm(&m_osTimer);
+		m_bOwnOsTimer = false;
+	}
+}
+
+#else
+
+Timer* Timer::s_pFirstTimerWithDeadline = NULL;
+Timer* Timer::s_pFirstExpired = NULL;
+
+
+Timer::Timer() : m_pNext(NULL), m_ppLink(NULL), m_pSignal(NULL), m_uDeadline(0), m_uPeriodUs(0), m_iLastJitterUs(0), m_uMaxJitterUs(0),
+                 m_uNrOfOverruns(0), m_OverrunPolicy(SkipMissedPeriods), m_bAbsoluteDeadlines(false), m_uSlackUs(0), m_uWakeUpTime(0)
+{
+}
+
+
+void ICACHE_FLASH_ATTR Timer::start(int ms, bool bRepeat, Signal* pSignal, int slackMs)
+{
+	unlink(this);
+	m_pSignal = pSignal;
+	m_uDeadline = getTime() + (uint64)(ms > 0 ? ms : 0) * 1000;
+	m_uPeriodUs = bRepeat ? (uint64)(ms > 0 ? ms : 0) * 1000 : 0;
+	m_OverrunPolicy = SkipMissedPeriods;
+	m_uSlackUs = slackMs > 0 ? (uint32)slackMs * 1000 : 0;
+	m_bAbsoluteDeadlines = (m_uSlackUs > 0);
+	if (m_bAbsoluteDeadlines)
+	{
+		armForDeadline();
+	}
+	else
+	{
+		armOsTimer(ms, bRepeat, false);
+	}
+}
+
+
+#ifdef USE_US_TIMER
+void ICACHE_FLASH_ATTR Timer::startUs(uint32 us, bool bRepeat, Signal* pSignal)
+{
+	unlink(this);
+	m_pSignal = pSignal;
+	m_uDeadline = getTime() + us;
+	m_uPeriodUs = bRepeat ? us : 0;
+	m_bAbsoluteDeadlines = false;
+	armOsTimer(us, bRepeat, true);
+}
+#endif
+
+
+void ICACHE_FLASH_ATTR Timer::startPeriodic(int ms, OverrunPolicy policy, Signal* pSignal, int slackMs)
+{
+	unlink(this);
+	m_pSignal = pSignal;
+	m_uPeriodUs = (uint64)(ms > 0 ? ms : 1) * 1000;
+	m_uDeadline = getTime() + m_uPeriodUs;
+	m_OverrunPolicy = policy;
+	m_uSlackUs = slackMs > 0 ? (uint32)slackMs * 1000 : 0;
+	m_bAbsoluteDeadlines = true;
+	armForDeadline();
+}
+
+
+void ICACHE_FLASH_ATTR Timer::armForDeadline()
+{
+	// the timer wakes up together with the earliest other timer in the slack window, or at the end of the window (like the SDK, this is
+	// O(number of armed timers))
+	uint64 uWakeUpTime = m_uDeadline + m_uSlackUs;
+	if (m_uSlackUs > 0)
+	{
+		for (Timer* pTimer = s_pFirstTimerWithDeadline; NULL != pTimer; pTimer = pTimer->m_pNext)
+		{
+			if (pTimer->m_uWakeUpTime >= m_uDeadline && pTimer->m_uWakeUpTime < uWakeUpTime)
+			{
+				uWakeUpTime = pTimer->m_uWakeUpTime;
+			}
+		}
+	}
+	m_uWakeUpTime = uWakeUpTime;
+	unlink(this);
+	link(&s_pFirstTimerWithDeadline, this);
+	armWakeUp();
+}
+
+
+void ICACHE_FLASH_ATTR Timer::armWakeUp()
+{
+	uint64 uNow = getTime();
+	uint32 uDelayUs = 0;
+	if (m_uWakeUpTime > uNow)
+	{
+		uDelayUs = (m_uWakeUpTime - uNow < MAX_OS_TIMER_DELAY_US) ? (uint32)(m_uWakeUpTime - uNow) : MAX_OS_TIMER_DELAY_US;
+	}
+#ifdef USE_US_TIMER
+	armOsTimer(uDelayUs, false, true);
+#else
+	// rounded to the nearest millisecond: the error of one expiry doesn't influence the next deadline
+	armOsTimer((uDelayUs + 500) / 1000, false, false);
+#endif
+}
+
+
+void ICACHE_FLASH_ATTR Timer::expireTimersWithDeadline(Timer* pTimer)
+{
+	// the timers, whose deadline has passed, or which were coalesced with pTimer, are moved to a list, because the slots might start and
+	// stop timers (even the expired ones)
+	uint64 uNow = getTime();
+	if (pTimer->m_uWakeUpTime > uNow + 1000)
+	{
+		// only a part of a long wait has elapsed (the rounding to milliseconds is less)
+		pTimer->armWakeUp();
+		return;
+	}
+
+	Timer** ppLastExpired = &s_pFirstExpired;
+	Timer* pOther = s_pFirstTimerWithDeadline;
+	while (NULL != pOther)
+	{
+		Timer* pNext = pOther->m_pNext;
+		if (pOther == pTimer || pOther->m_uDeadline <= uNow || pOther->m_uWakeUpTime == pTimer->m_uWakeUpTime)
+		{
+			unlink(pOther);
+			link(ppLastExpired, pOther);
+			ppLastExpired = &pOther->m_pNext;
+		}
+		pOther = pNext;
+	}
+
+	while (NULL != s_pFirstExpired)
+	{
+		Timer* pExpired = s_pFirstExpired;
+		unlink(pExpired);
+		os_timer_disarm(&pExpired->m_osTimer);
+		pExpired->expire();
+	}
 }
 
 
 void ICACHE_FLASH_ATTR Timer::stop()
 {
 	os_timer_disarm(&m_osTimer);
+	unlink(this);
 }
+
+#endif
@@ -1,12 +1,53 @@
 #ifndef TIMER_H_INCLUDED
 #define TIMER_H_INCLUDED
 
+/* ************************************************************************** */
+/* *************     Configuration settings                ****************** */
+/* ************************************************************************** */
+
+extern "C"
+{
+	#include <user_config.h>
+}
+
+/* Backend of the Timer objects:
+   - 0: each Timer arms its own os_timer. The SDK keeps the armed timers in a sorted list, so start() and stop() cost O(number of armed timers).
+   - 1: all Timers share one os_timer. The Timers are stored in the buckets of a timer wheel, so start() and stop() are O(1), and the timers,
+        which expire in the same tick, are processed together. The shared os_timer is only armed for the ticks, in which a timer can expire.
+        The resolution of the timers is TIMER_WHEEL_TICK_MS: a timer expires in the first tick after its deadline. The deadlines of a
+        repeating timer are exact multiples of its period (in microseconds), so the rounding to ticks doesn't accumulate.
+*/
+#ifndef TIMER_WHEEL
+#define TIMER_WHEEL 0
+//#define TIMER_WHEEL 1
+#endif
+
+// length of a tick of the timer wheel in milliseconds
+#ifndef TIMER_WHEEL_TICK_MS
+#define TIMER_WHEEL_TICK_MS 10
+#endif
+
+// number of buckets of the timer wheel (must be a power of two). A timer, which expires more than one turn of the wheel later, stays in its
+// bucket for more turns, so the size only has to be big enough to spread the running timers.
+#ifndef TIMER_WHEEL_SIZE
+#define TIMER_WHEEL_SIZE 64
+#endif
+
+// number of the pending calls of Timer::singleShot() (each one needs an os_timer and a slot, 36 bytes)
+#ifndef NR_OF_SINGLE_SHOT_TIMERS
+#define NR_OF_SINGLE_SHOT_TIMERS 4
+#endif
+
+/* *************     End configuration settings           ******************* */
+
+
 extern "C"
 {
 	#include <osapi.h>
 }
 
 #include "Signal.h"
+#include "MemoryPool.h"
 
 
 namespace Esp8266Base
@@ -17,6 +58,9 @@ namespace Esp8266Base
 
    This is a simple timer class, which wraps the C stype API functions of Espressif SDK,
    and provides an object oriented interface for timer functionality.
+   The deadlines are measured with 64 bits (system_get_time() overflows after 71 minutes), so start() and startPeriodic() accept any
+   positive int. Only start() without slack (and without TIMER_WHEEL) arms the os_timer directly, and it is limited by the SDK to
+   0x68D7A3 ms (about 114 minutes).
  */
 class Timer
 {
@@ -27,10 +71,49 @@ public:
 	Signal timeOut;
 
 
+	/* What a periodic timer (see startPeriodic()) does, if it couldn't expire in time, and the next period has already started
+	   (e.g. because a slot was running too long).
+	*/
+	enum OverrunPolicy
+	{
+		//! The timer expires once, and the missed periods are skipped: the next expiry is at the next deadline, which is in the future (default)
+		SkipMissedPeriods,
+
+		//! The timer expires once for each missed period (immediately one after the other), so the number of expiries is exact
+		CatchUpMissedPeriods
+	};
+
+
+	/*! Default constructor.
+	*/
+	Timer();
+
+
 	/*! Starts the timer. If pSignal is defined, then pSignal will be emitted, if the timer expires.
 	    If pSignal is not defined, then the member signal timeOut will be emitted, if the timer expires.
+	    If slackMs is defined, then the timer may expire up to slackMs later than ms: it expires together with an other timer, whose wake up
+	    is in this window, so the timers with nearby deadlines cause only one wake up (the jitter includes the delay). With slack the
+	    Timer arms its os_timer for the deadline itself, so ms isn't limited by os_timer_arm() (see the description of the class).
+	*/
+	void ICACHE_FLASH_ATTR start(int ms, bool bRepeat = false, Signal* pSignal = NULL, int slackMs = 0);
+
+
+#ifdef USE_US_TIMER
+	/*! Starts the timer with microsecond resolution (the same as start(), but the time is given in microseconds, between 100 and 0xFFFFFFF).
+	    It uses the own os_timer of the Timer (also with TIMER_WHEEL, whose resolution is only TIMER_WHEEL_TICK_MS).
+	    The SDK supports it only, if the application is compiled with USE_US_TIMER, and calls system_timer_reinit() at the beginning of
+	    user_init() (which changes the maximum of the other os_timers to 0x68D7A3 ms).
+	*/
+	void ICACHE_FLASH_ATTR startUs(uint32 us, bool bRepeat = false, Signal* pSignal = NULL);
+#endif
+
+
+	/*! Starts a periodic timer, whose deadlines are computed from the start time (n * ms later, measured with system_get_time()), and not from
+	    the previous expiry. So the latency of the callbacks and of the slots doesn't accumulate, and the timer doesn't drift over hours.
+	    If a deadline is missed, the timer follows the policy, and each missed period is counted as an overrun (see getNrOfOverruns()).
+	    pSignal and slackMs are the same as for start() (each deadline has its own slack window, so the slack doesn't accumulate either).
 	*/
-	void ICACHE_FLASH_ATTR start(int ms, bool bRepeat = false, Signal* pSignal = NULL);
+	void ICACHE_FLASH_ATTR startPeriodic(int ms, OverrunPolicy policy = SkipMissedPeriods, Signal* pSignal = NULL, int slackMs = 0);
 
 
 	/*! Stops the timer.
@@ -43,12 +126,164 @@ public:
 	Signal* ICACHE_FLASH_ATTR getUserSignal() const { return m_pSignal; }
 
 
+	/*! Returns the difference between the measured and the expected time of the last expiry in microseconds (positive, if the timer
+	    expired late). It shows, how much earlier a timer must be started to do something in time (e.g. to end a duty cycle).
+	*/
+	sint32 ICACHE_FLASH_ATTR getLastJitterUs() const { return m_iLastJitterUs; }
+
+
+	/*! Returns the biggest absolute value of the jitter (see getLastJitterUs()) since the Timer has been created.
+	*/
+	uint32 ICACHE_FLASH_ATTR getMaxJitterUs() const { return m_uMaxJitterUs; }
+
+
+	/*! Returns the number of missed periods of the periodic timer since the Timer has been created (with CatchUpMissedPeriods the number of
+	    expiries, which happened after the next period had already started). With TIMER_WHEEL the repeating timers of start() are counted too.
+	*/
+	uint32 ICACHE_FLASH_ATTR getNrOfOverruns() const { return m_uNrOfOverruns; }
+
+
+	/*! Calls the slot receiverFunction of the object receiverObject once, ms milliseconds later (from the os_timer callback, like a
+	    DirectConnection of timeOut). No Timer object is needed: the pending call is stored in a record of a static pool (see
+	    NR_OF_SINGLE_SHOT_TIMERS), which is released before the slot is called, so the slot can start the next singleShot() itself.
+	    Returns false, if all records are in use (the failures are counted by getSingleShotPool()).
+	    Unlike restarting a Timer, calling it again doesn't replace the pending call (the slot is called twice), so a Timer member suits a
+	    delay, which is restarted, or which mustn't fail after a side effect (e.g. after a command has been sent to a device).
+	    If receiverObject is destroyed before the call, then the call must be cancelled with cancelSingleShots().
+	*/
+	template < class X, class Y >
+	static bool singleShot(int ms, Y *receiverObject, void (X::* receiverFunction)(void*))
+	{
+		Signal::VoidFunction fcnt; fcnt.bind(receiverObject, receiverFunction);
+		return startSingleShot(ms, fcnt.GetMemento());
+	}
+
+	/*! The same as singleShot() with a member function, but it calls the free function (or lambda without captures) receiverFunction.
+	*/
+	static bool singleShot(int ms, void (*receiverFunction)(void*))
+	{
+		Signal::VoidFunction fcnt; fcnt.bind(receiverFunction);
+		return startSingleShot(ms, fcnt.GetMemento());
+	}
+
+	/*! Cancels the pending singleShot() calls of receiverObject/receiverFunction. Returns the number of cancelled calls.
+	*/
+	template < class X, class Y >
+	static int cancelSingleShots(Y *receiverObject, void (X::* receiverFunction)(void*))
+	{
+		Signal::VoidFunction fcnt; fcnt.bind(receiverObject, receiverFunction);
+		return cancelSingleShotSlot(fcnt.GetMemento());
+	}
+
+	/*! Cancels the pending singleShot() calls of the free function receiverFunction. Returns the number of cancelled calls.
+	*/
+	static int cancelSingleShots(void (*receiverFunction)(void*))
+	{
+		Signal::VoidFunction fcnt; fcnt.bind(receiverFunction);
+		return cancelSingleShotSlot(fcnt.GetMemento());
+	}
+
+	/*! Returns the memory pool of the singleShot() records (e.g. to read the number of pending calls, the high water mark, and the number of
+	    calls, which failed because the pool was exhausted)
+	*/
+	static const MemoryPoolBase& ICACHE_FLASH_ATTR getSingleShotPool();
+
+
 private:
 
+	// disable copy constructor
+	Timer(const Timer&);
+
+	// disable operator=
+	Timer& operator=(const Timer&);
+
+	// Next Timer in the same list (a bucket of the timer wheel, the list of the timers with a deadline, or the list of the expired timers)
+	Timer* m_pNext;
+
+	// Pointer to the pointer, which points to this Timer (the head of the list, or m_pNext of the previous Timer), NULL if it isn't linked
+	Timer** m_ppLink;
+
+	// Links the timer at the beginning of a list, and unlinks it from its list
+	static void ICACHE_FLASH_ATTR link(Timer** ppLink, Timer* pTimer);
+	static void ICACHE_FLASH_ATTR unlink(Timer* pTimer);
+
+#if TIMER_WHEEL
+	// The timer wheel needs to link the Timers and to emit their signals
+	friend class TimerWheel;
+
+	// Tick of the timer wheel, in which the timer expires
+	uint32 m_uExpiryTick;
+
+	// The tick of the deadline (m_uExpiryTick is later, if the timer has been coalesced), and the slack in ticks
+	uint32 m_uDueTick;
+	uint32 m_uSlackTicks;
+
+	// The timer has been started by startUs(), so it uses m_osTimer instead of the wheel
+	bool m_bOwnOsTimer;
+#endif
+
+	// Own os_timer of the Timer (with TIMER_WHEEL only used by startUs())
 	os_timer_t m_osTimer;
 
 	Signal* m_pSignal;
 
+	// Expected time of the next expiry (getTime()), and the period in microseconds (0 for a single-shot timer)
+	uint64 m_uDeadline;
+	uint64 m_uPeriodUs;
+
+	sint32 m_iLastJitterUs;
+	uint32 m_uMaxJitterUs;
+
+	uint32 m_uNrOfOverruns;
+	OverrunPolicy m_OverrunPolicy;
+
+#if !TIMER_WHEEL
+	// The timer has been started by startPeriodic() or with slack, so it is re-armed for m_uDeadline at each expiry, and it is linked in
+	// the list of the timers with a deadline (the wheel does it for all timers)
+	bool m_bAbsoluteDeadlines;
+
+	// The slack window after m_uDeadline, and the time (getTime()), at which the timer wakes up
+	uint32 m_uSlackUs;
+	uint64 m_uWakeUpTime;
+
+	// Timers with a deadline, whose os_timer is armed, and the timers, which expire in the current os_timer callback
+	static Timer* s_pFirstTimerWithDeadline;
+	static Timer* s_pFirstExpired;
+
+	// Arms m_osTimer for m_uDeadline (at least for now, if it has already passed), or for the earliest wake up of an other timer in the
+	// slack window
+	void ICACHE_FLASH_ATTR armForDeadline();
+
+	// Arms m_osTimer for m_uWakeUpTime, or for MAX_OS_TIMER_DELAY_US, if the wake up is later (then the wait is continued by the callback)
+	void ICACHE_FLASH_ATTR armWakeUp();
+
+	// Expires pTimer, and all other timers with a deadline, which can expire now
+	static void ICACHE_FLASH_ATTR expireTimersWithDeadline(Timer* pTimer);
+#endif
+
+	// Arms m_osTimer (with microseconds, if bMicroseconds is true)
+	void ICACHE_FLASH_ATTR armOsTimer(uint32 uTime, bool bRepeat, bool bMicroseconds);
+
+	// Returns system_get_time() extended to 64 bits. Its overflows are counted, so it must be called at least once in 71 minutes, while a
+	// timer with a deadline is running (the timers, which wait longer, wake up in between).
+	static uint64 ICACHE_FLASH_ATTR getTime();
+
+	// The last value of system_get_time() seen by getTime(), and the number of its overflows
+	static uint32 s_uLastSystemTime;
+	static uint32 s_uNrOfSystemTimeOverflows;
+
+	// Callback of m_osTimer
+	static void ICACHE_FLASH_ATTR osTimerCallback(void* pTimer);
+
+	// Measures the jitter, moves the deadline to the next period (and uNrOfSkippedPeriods more), and emits the signals
+	void ICACHE_FLASH_ATTR expire(uint32 uNrOfSkippedPeriods = 0);
+
+	// Allocates a singleShot() record for the slot, and arms its os_timer. Returns false, if the pool is exhausted.
+	static bool ICACHE_FLASH_ATTR startSingleShot(int ms, const DelegateMemento& slot);
+
+	// Releases the pending singleShot() records of the slot, and returns their number
+	static int ICACHE_FLASH_ATTR cancelSingleShotSlot(const DelegateMemento& slot);
+
 };
 
 }
@@ -0,0 +1,37 @@
+#include "Trace.h"
+#include "debug.h"
+
+using namespace Esp8266Base;
+
+#if TRACE_BUFFER_SIZE > 0
+Trace::Record Trace::s_arrayRecords[TRACE_BUFFER_SIZE];
+uint32 Trace::s_uNextRecord = 0;
+#endif
+
+
+void ICACHE_FLASH_ATTR Trace::dump()
+{
+#if TRACE_BUFFER_SIZE > 0
+	// the record counter is copied, so that the records written during the dump don't disturb it
+	uint32 uEnd = s_uNextRecord;
+	uint32 uBegin = (uEnd > TRACE_BUFFER_SIZE) ? uEnd - TRACE_BUFFER_SIZE : 0;
+
+	print("TRACE BEGIN %u\n", uBegin);
+	for (uint32 i = uBegin; i != uEnd; ++i)
+	{
+		const Record& rec = s_arrayRecords[i & (TRACE_BUFFER_SIZE - 1)];
+		print("TR %08x%08x%08x%08x\n", rec.uTimestamp, rec.uEvent, (uint32)(size_t)rec.pObject, rec.uArgument);
+	}
+	print("TRACE END\n");
+#else
+	print("TRACE BEGIN 0\nTRACE END\n");
+#endif
+}
+
+
+void ICACHE_FLASH_ATTR Trace::clear()
+{
+#if TRACE_BUFFER_SIZE > 0
+	s_uNextRecord = 0;
+#endif
+}
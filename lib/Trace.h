@@ -0,0 +1,125 @@
+#ifndef TRACE_H_INCLUDED
+#define TRACE_H_INCLUDED
+
+/* ************************************************************************** */
+/* *************     Configuration settings                ****************** */
+/* ************************************************************************** */
+
+extern "C"
+{
+	#include <user_config.h>
+}
+
+/* Number of records in the trace ring (must be a power of two). Each record needs 16 bytes of RAM.
+   - 0: no tracing (Trace::record() is empty, and there is no RAM overhead)
+   - otherwise: the last TRACE_BUFFER_SIZE events are stored, and they can be printed with Trace::dump()
+*/
+#ifndef TRACE_BUFFER_SIZE
+#define TRACE_BUFFER_SIZE 0
+//#define TRACE_BUFFER_SIZE 256
+#endif
+
+/* *************     End configuration settings           ******************* */
+
+
+extern "C"
+{
+	#include <c_types.h>
+	#include <user_interface.h>
+}
+
+namespace Esp8266Base
+{
+
+/*! \class Trace
+    \brief Ring of binary trace records in RAM
+
+   Unlike debug(), recording an event doesn't print anything: it only stores a record of 16 bytes (timestamp, event id,
+   object pointer, argument) in a ring, so it doesn't change the timing of the traced code much.
+   The ring is printed over UART with dump() on demand, and tools/decode_trace.py converts the output into a timeline.
+   Restrictions:
+   - the oldest records are overwritten, if the ring is full
+   - record() may be interrupted by an interrupt handler, which records too: in this case one of the records might be lost
+   .
+ */
+class Trace
+{
+public:
+
+	/* The ids of the events. The decoder (tools/decode_trace.py) knows the same ids, keep them in sync.
+	*/
+	enum Event
+	{
+		//! Signal::emit() (object: the signal, argument: the parameter)
+		SignalEmit = 1,
+
+		//! The task of the queued signals starts to process an event (argument: the sig of the event in the upper 16 bits, the par in the lower 16 bits)
+		TaskInvokeSlotStart = 2,
+
+		//! The task of the queued signals finished an event (argument: the same as for TaskInvokeSlotStart)
+		TaskInvokeSlotEnd = 3,
+
+		//! A Timer expired (object: the timer, argument: the jitter of the expiry in microseconds, see Timer::getLastJitterUs())
+		TimerExpired = 4,
+
+		//! An ESP-now message has been received (object: the received data, argument: its length)
+		EspNowReceived = 5,
+
+		//! An ESP-now message has been sent (argument: the status, 0 means success)
+		EspNowSent = 6,
+
+		//! The first id, which can be used by the application
+		FirstUserEvent = 0x100
+	};
+
+	/* A record of the ring. dump() prints it as four 32 bit hex numbers.
+	*/
+	struct Record
+	{
+		uint32 uTimestamp;
+		uint32 uEvent;
+		const void* pObject;
+		uint32 uArgument;
+	};
+
+
+	/*! Stores an event in the ring (it costs only a call of system_get_time() and four stores).
+	*/
+	static void record(uint32 uEvent, const void* pObject = NULL, uint32 uArgument = 0)
+	{
+#if TRACE_BUFFER_SIZE > 0
+		Record& rec = s_arrayRecords[s_uNextRecord++ & (TRACE_BUFFER_SIZE - 1)];
+		rec.uTimestamp = system_get_time();
+		rec.uEvent = uEvent;
+		rec.pObject = pObject;
+		rec.uArgument = uArgument;
+#endif
+	}
+
+
+	/*! Prints the records (the oldest first) over UART, one record per line in hex: "TR <timestamp><event><object><argument>",
+	    framed by "TRACE BEGIN <number of lost records>" and "TRACE END". The ring is not cleared.
+	*/
+	static void ICACHE_FLASH_ATTR dump();
+
+
+	/*! Removes all records from the ring.
+	*/
+	static void ICACHE_FLASH_ATTR clear();
+
+private:
+
+#if TRACE_BUFFER_SIZE > 0
+	// TRACE_BUFFER_SIZE must be a power of two (the array size is negative otherwise, and the compilation fails)
+	typedef char SizeMustBePowerOfTwo[(TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) == 0 ? 1 : -1];
+
+	static Record s_arrayRecords[TRACE_BUFFER_SIZE];
+
+	// number of records since startup (or clear()), the next record is stored at s_uNextRecord % TRACE_BUFFER_SIZE
+	static uint32 s_uNextRecord;
+#endif
+};
+
+}
+
+#endif
@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+"""Decodes the dumps of TraceTest with tools/decode_trace.py: the records of the ring after the wraparound, and the names of the
+events and arguments recorded by Signal and Timer.
+
+Usage: DecodeTraceTest.py <log file of TraceTest>
+"""
+
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "tools"))
+import decode_trace
+
+# the same as in TraceTest.cpp
+TRACE_BUFFER_SIZE = 16
+NR_OF_LOST_RECORDS = 5
+
+failures = []
+
+
+def check(condition, text):
+    if not condition:
+        failures.append(text)
+        print("DecodeTraceTest.py: check %s failed" % text)
+
+
+def main():
+    lines = open(sys.argv[1]).read().splitlines()
+
+    # the first dump: the records after the wraparound, 10 us apart
+    first_dump = decode_trace.parse(lines[:lines.index("TRACE END") + 1])
+    check(len(first_dump) == TRACE_BUFFER_SIZE, "number of records after the wraparound")
+    for i, (timestamp, event, obj, argument) in enumerate(first_dump):
+        check(decode_trace.event_name(event) == "User+%d" % (NR_OF_LOST_RECORDS + i), "event name of record %d" % i)
+        check(obj == 0x3ffe8000 + 4 * (NR_OF_LOST_RECORDS + i), "object of record %d" % i)
+        check(argument == 0xa0000000 + NR_OF_LOST_RECORDS + i, "argument of record %d" % i)
+        if i > 0:
+            check((timestamp - first_dump[i - 1][0]) & 0xffffffff == 10, "delta of record %d" % i)
+
+    # the last dump: the events of Signal and Timer
+    last_dump = decode_trace.parse(lines)
+    decoded = [(decode_trace.event_name(event), decode_trace.argument_text(event, argument))
+               for timestamp, event, obj, argument in last_dump]
+    check(decoded[0][0] == "SignalEmit", "SignalEmit")
+    check(("TaskInvokeSlotStart", "INVOKE_SLOT low") in decoded, "TaskInvokeSlotStart")
+    check(("TaskInvokeSlotEnd", "INVOKE_SLOT low") in decoded, "TaskInvokeSlotEnd")
+    check(decoded[-1] == ("TimerExpired", "jitter -20 us"), "TimerExpired")
+    check((last_dump[-1][0] - last_dump[0][0]) & 0xffffffff == 100, "duration of the last dump")
+
+    print("DecodeTraceTest.py: %s" % ("%d checks failed" % len(failures) if failures else "OK"))
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,167 @@
+/* Signal::emitFromIsr(): the signals emitted by an interrupt handler are delivered even if the event queue of the low priority task
+   is full, and a pending EMIT_FROM_ISR event doesn't take the place of a queued slot. Finally a second thread plays the role of the
+   interrupt handler, and emits a sequence of signals, while the task runs queued slots of the low priority.
+*/
+
+#include "Test.h"
+#include "SdkSim.h"
+#include "Signal.h"
+
+#include <stdlib.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+
+extern "C"
+{
+	#include <user_interface.h>
+}
+
+using namespace Esp8266Base;
+
+namespace
+{
+
+class Receiver
+{
+public:
+	Receiver() : m_iNrOfCalls(0), m_iNextValue(0), m_iNrOfWrongValues(0) {}
+
+	void slot(void*)
+	{
+		++m_iNrOfCalls;
+	}
+
+	// the parameter points to the next value of a sequence
+	void sequenceSlot(void* pParameter)
+	{
+		++m_iNrOfCalls;
+		int iValue = *static_cast<int*>(pParameter);
+		if (iValue != m_iNextValue)
+		{
+			++m_iNrOfWrongValues;
+		}
+		m_iNextValue = iValue + 1;
+	}
+
+	int m_iNrOfCalls;
+	int m_iNextValue;
+	int m_iNrOfWrongValues;
+};
+
+
+void testFullEventQueue()
+{
+	Signal signalQueued, signalFromIsr;
+	Receiver queued, fromIsr;
+	signalQueued.connect(&queued, &Receiver::slot, SignalBase::QueuedConnection);
+	signalFromIsr.connect(&fromIsr, &Receiver::slot, SignalBase::DirectConnection);
+
+	// the invoke data (and without a time budget the INVOKE_SLOT events) of the low priority are full
+	for (int i = 0; i < MAX_NR_OF_QUEUED_SIGNALS; ++i)
+	{
+		signalQueued.emit(NULL);
+	}
+#if QUEUED_SIGNALS_TIME_BUDGET_US > 0
+	CHECK(SdkSim::getNrOfPendingEvents(USER_TASK_PRIO_0) == 1);
+#else
+	CHECK(SdkSim::getNrOfPendingEvents(USER_TASK_PRIO_0) == MAX_NR_OF_QUEUED_SIGNALS);
+#endif
+
+	CHECK(signalFromIsr.emitFromIsr(NULL));
+	SdkSim::runTasks();
+	CHECK(queued.m_iNrOfCalls == MAX_NR_OF_QUEUED_SIGNALS);
+	CHECK(fromIsr.m_iNrOfCalls == 1);
+}
+
+
+void testPendingIsrEmit()
+{
+	Signal signalQueued, signalFromIsr;
+	Receiver queued, fromIsr;
+	signalQueued.connect(&queued, &Receiver::slot, SignalBase::QueuedConnection);
+	signalFromIsr.connect(&fromIsr, &Receiver::slot, SignalBase::DirectConnection);
+
+	// the EMIT_FROM_ISR event is pending, when the invoke data is filled
+	CHECK(signalFromIsr.emitFromIsr(NULL));
+	uint32 uNrOfOverflows = SignalBase::getNrOfOverflows(SignalBase::LowPriority, SignalBase::DropNewest);
+	for (int i = 0; i < MAX_NR_OF_QUEUED_SIGNALS; ++i)
+	{
+		signalQueued.emit(NULL);
+	}
+	CHECK(SignalBase::getNrOfOverflows(SignalBase::LowPriority, SignalBase::DropNewest) == uNrOfOverflows);
+
+	SdkSim::runTasks();
+	CHECK(queued.m_iNrOfCalls == MAX_NR_OF_QUEUED_SIGNALS);
+	CHECK(fromIsr.m_iNrOfCalls == 1);
+}
+
+
+const int NR_OF_EMITS_FROM_THREAD = 100000;
+
+Signal g_signalFromThread;
+volatile int g_iNrOfFailedEmits = 0;
+
+// The "interrupt handler": emits the values 0, 1, 2, ... (the signal frees them after the slot), and retries, if the queue is full
+void* producerThread(void*)
+{
+	for (int i = 0; i < NR_OF_EMITS_FROM_THREAD; ++i)
+	{
+		int* pValue = static_cast<int*>(malloc(sizeof(int)));
+		*pValue = i;
+		while (!g_signalFromThread.emitFromIsr(pValue))
+		{
+			++g_iNrOfFailedEmits;
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+
+void testProducerThread()
+{
+	Receiver fromThread, queued;
+	g_signalFromThread.connect(&fromThread, &Receiver::sequenceSlot, SignalBase::DirectConnection);
+	Signal signalQueued;
+	signalQueued.connect(&queued, &Receiver::slot, SignalBase::QueuedConnection);
+
+	pthread_t thread;
+	CHECK(0 == pthread_create(&thread, NULL, &producerThread, NULL));
+
+	// the task runs queued slots of the low priority too, while the thread emits (and it lets the thread run on a single core)
+	time_t timeout = time(NULL) + 20;
+	int iNrOfQueuedEmits = 0;
+	while (fromThread.m_iNrOfCalls < NR_OF_EMITS_FROM_THREAD && time(NULL) < timeout)
+	{
+		signalQueued.emit(NULL);
+		++iNrOfQueuedEmits;
+		SdkSim::runTasks();
+		sched_yield();
+	}
+	pthread_join(thread, NULL);
+	SdkSim::runTasks();
+
+	printf("%d signals from the thread (%d retries, because the queue was full), %d queued slots\n", fromThread.m_iNrOfCalls,
+	       g_iNrOfFailedEmits, queued.m_iNrOfCalls);
+	CHECK(fromThread.m_iNrOfCalls == NR_OF_EMITS_FROM_THREAD);
+	CHECK(fromThread.m_iNrOfWrongValues == 0);
+	CHECK(queued.m_iNrOfCalls == iNrOfQueuedEmits);
+	CHECK(SdkSim::getNrOfPendingEvents(USER_TASK_PRIO_0) == 0);
+}
+
+} // namespace
+
+
+int main()
+{
+	testFullEventQueue();
+	testPendingIsrEmit();
+	testProducerThread();
+
+#if QUEUED_SIGNALS_TIME_BUDGET_US > 0
+	return testResult("IsrEmitTest (QUEUED_SIGNALS_TIME_BUDGET_US)");
+#else
+	return testResult("IsrEmitTest");
+#endif
+}
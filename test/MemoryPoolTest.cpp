@@ -0,0 +1,116 @@
+/* MemoryPool: allocation and release of the blocks, the statistics (used blocks, high-water mark, failed allocations), and
+   releaseToOwnerPool(), which the signals use to free their parameters, and EspWifi to free its messages.
+*/
+
+#include "Test.h"
+#include "MemoryPool.h"
+
+#include <stdlib.h>
+
+using namespace Esp8266Base;
+
+namespace
+{
+
+// The pools are global like in the library: they are usable without constructors, because they are zero initialized
+MemoryPool<12, 3> g_poolMessages;
+MemoryPool<1, 4> g_poolBytes;
+MemoryPool<sizeof(int), 2> g_poolIntegers;
+MemoryPool<16, 2> g_poolUnused;
+
+
+// The blocks don't overlap, they are aligned to 4 bytes, and a released block is reused
+void testAllocateAndRelease()
+{
+	void* arrayBlocks[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		arrayBlocks[i] = g_poolMessages.allocate();
+		CHECK(NULL != arrayBlocks[i]);
+		CHECK(0 == ((size_t)arrayBlocks[i] & 3));
+		CHECK(g_poolMessages.owns(arrayBlocks[i]));
+		CHECK(g_poolMessages.getNrOfUsedBlocks() == (unsigned int)i + 1);
+	}
+	CHECK((char*)arrayBlocks[1] >= (char*)arrayBlocks[0] + 12 && (char*)arrayBlocks[2] >= (char*)arrayBlocks[1] + 12);
+
+	CHECK(g_poolMessages.release(arrayBlocks[1]));
+	CHECK(g_poolMessages.getNrOfUsedBlocks() == 2);
+	CHECK(g_poolMessages.allocate() == arrayBlocks[1]);
+
+	// a block of an other pool isn't released
+	void* pByte = g_poolBytes.allocate();
+	CHECK(!g_poolMessages.release(pByte));
+	CHECK(!g_poolMessages.owns(pByte));
+	CHECK(g_poolMessages.getNrOfUsedBlocks() == 3);
+
+	// the blocks of a pool with small blocks can store the pointer of the free list
+	void* pByte2 = g_poolBytes.allocate();
+	CHECK((size_t)((char*)pByte2 - (char*)pByte) >= sizeof(void*));
+	CHECK(g_poolBytes.release(pByte2));
+	CHECK(g_poolBytes.release(pByte));
+
+	for (int i = 0; i < 3; ++i)
+	{
+		CHECK(g_poolMessages.release(arrayBlocks[i]));
+	}
+	CHECK(g_poolMessages.getNrOfUsedBlocks() == 0);
+	CHECK(g_poolMessages.getNrOfAllocationFailures() == 0);
+}
+
+
+// An allocation fails, if all blocks are used: it is counted, and the high-water mark stays at the number of blocks after the release
+void testHighWaterMarkAndFailures()
+{
+	void* p1 = g_poolIntegers.allocate();
+	CHECK(g_poolIntegers.getHighWaterMark() == 1);
+	void* p2 = g_poolIntegers.allocate();
+	CHECK(NULL != p1 && NULL != p2);
+	CHECK(NULL == g_poolIntegers.allocate());
+	CHECK(NULL == g_poolIntegers.allocate());
+	CHECK(g_poolIntegers.getNrOfAllocationFailures() == 2);
+	CHECK(g_poolIntegers.getHighWaterMark() == g_poolIntegers.getNrOfBlocks());
+
+	CHECK(g_poolIntegers.release(p1));
+	CHECK(g_poolIntegers.release(p2));
+	CHECK(g_poolIntegers.getNrOfUsedBlocks() == 0);
+	CHECK(g_poolIntegers.getHighWaterMark() == 2);
+
+	p1 = g_poolIntegers.allocate();
+	CHECK(NULL != p1);
+	CHECK(g_poolIntegers.getNrOfAllocationFailures() == 2);
+	CHECK(g_poolIntegers.getHighWaterMark() == 2);
+	CHECK(g_poolIntegers.release(p1));
+}
+
+
+// releaseToOwnerPool() finds the pool of a block, and returns false for the memory of the heap and of unused pools
+void testReleaseToOwnerPool()
+{
+	void* pMessage = g_poolMessages.allocate();
+	void* pInteger = g_poolIntegers.allocate();
+	void* pHeap = malloc(16);
+
+	CHECK(MemoryPoolBase::releaseToOwnerPool(pInteger));
+	CHECK(g_poolIntegers.getNrOfUsedBlocks() == 0);
+	CHECK(MemoryPoolBase::releaseToOwnerPool(pMessage));
+	CHECK(g_poolMessages.getNrOfUsedBlocks() == 0);
+	CHECK(!MemoryPoolBase::releaseToOwnerPool(pHeap));
+	free(pHeap);
+
+	// a pool registers itself at its first allocation, before it doesn't own anything
+	CHECK(!g_poolUnused.owns(&g_poolUnused));
+	CHECK(!MemoryPoolBase::releaseToOwnerPool(&g_poolUnused));
+	CHECK(g_poolUnused.getNrOfUsedBlocks() == 0);
+}
+
+} // namespace
+
+
+int main()
+{
+	testAllocateAndRelease();
+	testHighWaterMarkAndFailures();
+	testReleaseToOwnerPool();
+
+	return testResult("MemoryPoolTest");
+}
@@ -0,0 +1,134 @@
+/* A flood of low priority queued slots (each of them works 2 ms, and queues itself again) keeps the task of USER_TASK_PRIO_0 busy, while
+   a timer emits an urgent signal every 7 ms. The latency of the urgent slot (from the expiry of the timer until the call) must stay
+   below the runtime of one low priority slot, if it is connected with a higher priority, and it grows with the length of the flood
+   otherwise.
+*/
+
+#include "Test.h"
+#include "SdkSim.h"
+#include "Signal.h"
+
+extern "C"
+{
+	#include <osapi.h>
+	#include <user_interface.h>
+}
+
+using namespace Esp8266Base;
+
+namespace
+{
+
+const uint32 FLOOD_SLOT_RUNTIME_US = 2000;
+// the queue of the low priority keeps room for the urgent slot, if it is connected with LowPriority
+const int NR_OF_FLOOD_SLOTS = MAX_NR_OF_QUEUED_SIGNALS / 2;
+const uint32 URGENT_PERIOD_MS = 7;
+const uint64 TEST_DURATION_US = 1000000;
+
+class Flood
+{
+public:
+	Flood() : m_bRunning(true), m_iNrOfCalls(0)
+	{
+		m_signalWork.connect(this, &Flood::work, SignalBase::QueuedConnection);
+	}
+
+	void start()
+	{
+		for (int i = 0; i < NR_OF_FLOOD_SLOTS; ++i)
+		{
+			m_signalWork.emit(NULL);
+		}
+	}
+
+	void work(void*)
+	{
+		++m_iNrOfCalls;
+		SdkSim::advanceTime(FLOOD_SLOT_RUNTIME_US);
+		if (m_bRunning)
+		{
+			m_signalWork.emit(NULL);
+		}
+	}
+
+	Signal m_signalWork;
+	bool m_bRunning;
+	int m_iNrOfCalls;
+};
+
+class Urgent
+{
+public:
+	Urgent(SignalBase::Priority priority) : m_uExpiry(0), m_iNrOfCalls(0), m_uMaxLatencyUs(0)
+	{
+		m_signalUrgent.connect(this, &Urgent::handle, SignalBase::QueuedConnection, priority);
+		os_timer_setfn(&m_osTimer, &Urgent::timerCallback, this);
+	}
+
+	void start()
+	{
+		m_uExpiry = SdkSim::getTime();
+		os_timer_arm(&m_osTimer, URGENT_PERIOD_MS, true);
+	}
+
+	static void timerCallback(void* pArg)
+	{
+		Urgent* pThis = static_cast<Urgent*>(pArg);
+		pThis->m_uExpiry += URGENT_PERIOD_MS * 1000;
+		pThis->m_signalUrgent.emit((uint32)pThis->m_uExpiry);
+	}
+
+	void handle(uint32 uExpiry)
+	{
+		++m_iNrOfCalls;
+		uint32 uLatency = system_get_time() - uExpiry;
+		if (uLatency > m_uMaxLatencyUs)
+		{
+			m_uMaxLatencyUs = uLatency;
+		}
+	}
+
+	// the parameter is the expiry of the timer (system_get_time())
+	TypedSignal<uint32> m_signalUrgent;
+	os_timer_t m_osTimer;
+	uint64 m_uExpiry;
+	int m_iNrOfCalls;
+	uint32 m_uMaxLatencyUs;
+};
+
+// Runs the flood for TEST_DURATION_US, and returns the maximum latency of the urgent slot
+uint32 runFlood(SignalBase::Priority priority)
+{
+	Flood flood;
+	Urgent urgent(priority);
+
+	flood.start();
+	urgent.start();
+	SdkSim::runUntil(SdkSim::getTime() + TEST_DURATION_US);
+	os_timer_disarm(&urgent.m_osTimer);
+
+	flood.m_bRunning = false;
+	SdkSim::runTasks();
+
+	printf("priority %d: %d urgent calls (max latency %u us), %d flood calls\n", priority, urgent.m_iNrOfCalls,
+	       urgent.m_uMaxLatencyUs, flood.m_iNrOfCalls);
+
+	// the flood kept the low priority task busy all the time
+	CHECK(flood.m_iNrOfCalls >= (int)(TEST_DURATION_US / FLOOD_SLOT_RUNTIME_US));
+	CHECK(urgent.m_iNrOfCalls >= (int)(TEST_DURATION_US / 1000 / URGENT_PERIOD_MS) - 1);
+	return urgent.m_uMaxLatencyUs;
+}
+
+} // namespace
+
+
+int main()
+{
+	CHECK(runFlood(SignalBase::HighPriority) <= FLOOD_SLOT_RUNTIME_US);
+	CHECK(runFlood(SignalBase::MediumPriority) <= FLOOD_SLOT_RUNTIME_US);
+
+	// without a priority the urgent slot waits behind the whole flood
+	CHECK(runFlood(SignalBase::LowPriority) >= NR_OF_FLOOD_SLOTS * FLOOD_SLOT_RUNTIME_US);
+
+	return testResult("PriorityLatencyTest");
+}
@@ -0,0 +1,570 @@
+/* Regression tests of Signal: slots, which modify the connections of the emitted signal during the emit, coalesced calls, and nested
+   emits, when all queues are full.
+*/
+
+#include "Test.h"
+#include "SdkSim.h"
+#include "Signal.h"
+#include "MemoryPool.h"
+
+#include <stdlib.h>
+
+extern "C"
+{
+	#include <user_interface.h>
+}
+
+using namespace Esp8266Base;
+
+namespace
+{
+
+class Receiver
+{
+public:
+	Receiver() : m_pSignal(NULL), m_iNrOfCalls(0) {}
+
+	void slot(void*)
+	{
+		++m_iNrOfCalls;
+	}
+
+	// disconnects the given connections of m_pSignal
+	void disconnectingSlot(void*)
+	{
+		++m_iNrOfCalls;
+		for (int i = 0; i < m_iNrOfHandles; ++i)
+		{
+			m_pSignal->disconnect(m_arrayHandles[i]);
+		}
+	}
+
+	void setDisconnects(SignalBase* pSignal, SignalBase::ConnectionHandle handle1, SignalBase::ConnectionHandle handle2 = -1)
+	{
+		m_pSignal = pSignal;
+		m_arrayHandles[0] = handle1;
+		m_arrayHandles[1] = handle2;
+		m_iNrOfHandles = (-1 == handle2) ? 1 : 2;
+	}
+
+	SignalBase* m_pSignal;
+	SignalBase::ConnectionHandle m_arrayHandles[2];
+	int m_iNrOfHandles;
+	int m_iNrOfCalls;
+};
+
+
+// A slot disconnects itself and the next connection: the next one must not be called, but the one after it must be
+void testDisconnectNextDuringEmit()
+{
+	Signal signal;
+	Receiver a, b, c;
+	SignalBase::ConnectionHandle hA = signal.connect(&a, &Receiver::disconnectingSlot, SignalBase::DirectConnection);
+	SignalBase::ConnectionHandle hB = signal.connect(&b, &Receiver::slot, SignalBase::DirectConnection);
+	ScopedConnection connectionC(signal, signal.connect(&c, &Receiver::slot, SignalBase::DirectConnection));
+	a.setDisconnects(&signal, hA, hB);
+
+	signal.emit(NULL);
+	CHECK(a.m_iNrOfCalls == 1);
+	CHECK(b.m_iNrOfCalls == 0);
+	CHECK(c.m_iNrOfCalls == 1);
+
+	signal.emit(NULL);
+	CHECK(a.m_iNrOfCalls == 1);
+	CHECK(b.m_iNrOfCalls == 0);
+	CHECK(c.m_iNrOfCalls == 2);
+}
+
+
+// The same in fan-out mode: the task calls the queued slots of one emit, and a slot disconnects the next one
+void testDisconnectNextDuringFanOut()
+{
+	Signal signal;
+	signal.setFanOut(true);
+	Receiver a, b, c;
+	SignalBase::ConnectionHandle hA = signal.connect(&a, &Receiver::disconnectingSlot, SignalBase::QueuedConnection);
+	SignalBase::ConnectionHandle hB = signal.connect(&b, &Receiver::slot, SignalBase::QueuedConnection);
+	ScopedConnection connectionC(signal, signal.connect(&c, &Receiver::slot, SignalBase::QueuedConnection));
+	a.setDisconnects(&signal, hA, hB);
+
+	signal.emit(NULL);
+	SdkSim::runTasks();
+	CHECK(a.m_iNrOfCalls == 1);
+	CHECK(b.m_iNrOfCalls == 0);
+	CHECK(c.m_iNrOfCalls == 1);
+}
+
+
+// A single-shot slot disconnects the next connection: the walk must continue with the one after it
+void testDisconnectNextFromSingleShotSlot()
+{
+	Signal signal;
+	Receiver a, b, c;
+	signal.connectOnce(&a, &Receiver::disconnectingSlot, SignalBase::DirectConnection);
+	SignalBase::ConnectionHandle hB = signal.connect(&b, &Receiver::slot, SignalBase::DirectConnection);
+	ScopedConnection connectionC(signal, signal.connect(&c, &Receiver::slot, SignalBase::DirectConnection));
+	a.setDisconnects(&signal, hB);
+
+	signal.emit(NULL);
+	CHECK(a.m_iNrOfCalls == 1);
+	CHECK(b.m_iNrOfCalls == 0);
+	CHECK(c.m_iNrOfCalls == 1);
+
+	signal.emit(NULL);
+	CHECK(a.m_iNrOfCalls == 1);
+	CHECK(c.m_iNrOfCalls == 2);
+}
+
+
+// Returns a new parameter for Signal::emit() (the signal frees it)
+void* newParameter()
+{
+	return malloc(sizeof(int));
+}
+
+// A slot removes connections in the middle and at the end of the table: after the emit the table is compacted, the other connections and
+// their handles stay valid, and the whole table can be used again
+void testCompactionAfterRemovalsDuringEmit()
+{
+	Signal signal, other;
+	Receiver a, b, c, d, x, y;
+	SignalBase::ConnectionHandle hA = signal.connect(&a, &Receiver::disconnectingSlot, SignalBase::DirectConnection);
+	SignalBase::ConnectionHandle hX = other.connect(&x, &Receiver::slot, SignalBase::DirectConnection);
+	SignalBase::ConnectionHandle hB = signal.connect(&b, &Receiver::slot, SignalBase::DirectConnection);
+	SignalBase::ConnectionHandle hC = signal.connect(&c, &Receiver::slot, SignalBase::DirectConnection);
+	SignalBase::ConnectionHandle hY = other.connect(&y, &Receiver::slot, SignalBase::DirectConnection);
+	SignalBase::ConnectionHandle hD = signal.connect(&d, &Receiver::slot, SignalBase::DirectConnection);
+	a.setDisconnects(&signal, hB, hD);
+	int iNrOfConnections = SignalBase::getNrOfConnections();
+
+	signal.emit(NULL);
+	CHECK(SignalBase::getNrOfConnections() == iNrOfConnections - 2);
+	CHECK(b.m_iNrOfCalls == 0 && d.m_iNrOfCalls == 0);
+	CHECK(signal.isConnected(hA) && signal.isConnected(hC) && !signal.isConnected(hB) && !signal.isConnected(hD));
+	CHECK(other.isConnected(hX) && other.isConnected(hY));
+
+	signal.emit(NULL);
+	other.emit(NULL);
+	CHECK(a.m_iNrOfCalls == 2 && c.m_iNrOfCalls == 2);
+	CHECK(x.m_iNrOfCalls == 1 && y.m_iNrOfCalls == 1);
+
+	// no removed entry is left in the table
+	static SignalBase::ConnectionHandle arrayHandles[MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS];
+	int iNrOfFreeEntries = MAX_NR_OF_SIGNAL_SLOT_CONNECTIONS - SignalBase::getNrOfConnections();
+	Signal filler;
+	for (int i = 0; i < iNrOfFreeEntries; ++i)
+	{
+		arrayHandles[i] = filler.connect(&x, &Receiver::slot, SignalBase::DirectConnection);
+		CHECK(arrayHandles[i] != -1);
+	}
+	for (int i = 0; i < iNrOfFreeEntries; ++i)
+	{
+		filler.disconnect(arrayHandles[i]);
+	}
+	signal.disconnect(hA);
+	signal.disconnect(hC);
+	other.disconnect(hX);
+	other.disconnect(hY);
+}
+
+
+// The parameters of the coalesced calls are allocated from a pool, so that the test can see, when the signal releases them
+MemoryPool<sizeof(int), 4> g_poolParameters;
+
+void* newPoolParameter(int iValue)
+{
+	int* pValue = static_cast<int*>(g_poolParameters.allocate());
+	*pValue = iValue;
+	return pValue;
+}
+
+// Records the parameter of its last call
+class ParameterReceiver
+{
+public:
+	ParameterReceiver() : m_iNrOfCalls(0), m_iLastValue(0) {}
+
+	void slot(void* param)
+	{
+		++m_iNrOfCalls;
+		m_iLastValue = *static_cast<int*>(param);
+	}
+
+	int m_iNrOfCalls;
+	int m_iLastValue;
+};
+
+
+// A second emit replaces the parameter of the pending call of a CoalescedConnection, and releases the older parameter at once
+void testCoalescedEmits()
+{
+	Signal signal;
+	ParameterReceiver receiver;
+	ScopedConnection connection(signal, signal.connect(&receiver, &ParameterReceiver::slot, SignalBase::CoalescedConnection));
+
+	signal.emit(newPoolParameter(1));
+	CHECK(g_poolParameters.getNrOfUsedBlocks() == 1);
+	signal.emit(newPoolParameter(2));
+	CHECK(g_poolParameters.getNrOfUsedBlocks() == 1);
+	CHECK(SdkSim::getNrOfPendingEvents(USER_TASK_PRIO_0) == 1);
+
+	SdkSim::runTasks();
+	CHECK(receiver.m_iNrOfCalls == 1 && receiver.m_iLastValue == 2);
+	CHECK(g_poolParameters.getNrOfUsedBlocks() == 0);
+
+	// the call has been executed, so the next emit queues a new one
+	signal.emit(newPoolParameter(3));
+	SdkSim::runTasks();
+	CHECK(receiver.m_iNrOfCalls == 2 && receiver.m_iLastValue == 3);
+	CHECK(g_poolParameters.getNrOfUsedBlocks() == 0);
+}
+
+
+// A CoalescedConnection is disconnected, while its call is pending: the call is still executed, but it mustn't touch the new connection
+// in the same entry of the table
+void testDisconnectCoalescedWithPendingCall()
+{
+	Signal signal;
+	ParameterReceiver a, b;
+	SignalBase::ConnectionHandle hA = signal.connect(&a, &ParameterReceiver::slot, SignalBase::CoalescedConnection);
+
+	signal.emit(newPoolParameter(1));
+	CHECK(signal.disconnect(hA) == 1);
+	ScopedConnection connectionB(signal, signal.connect(&b, &ParameterReceiver::slot, SignalBase::CoalescedConnection));
+	signal.emit(newPoolParameter(2));
+	signal.emit(newPoolParameter(3));
+	CHECK(g_poolParameters.getNrOfUsedBlocks() == 2);
+
+	// the call of the removed connection doesn't end the pending call of the new one, so the next emit is coalesced
+	CHECK(SdkSim::runTask());
+	CHECK(a.m_iNrOfCalls == 1 && a.m_iLastValue == 1);
+	CHECK(b.m_iNrOfCalls == 0);
+	signal.emit(newPoolParameter(4));
+	CHECK(g_poolParameters.getNrOfUsedBlocks() == 1);
+
+	SdkSim::runTasks();
+	CHECK(a.m_iNrOfCalls == 1);
+	CHECK(b.m_iNrOfCalls == 1 && b.m_iLastValue == 4);
+	CHECK(g_poolParameters.getNrOfUsedBlocks() == 0);
+}
+
+
+// The compaction of the table moves a CoalescedConnection with a pending call: the call follows the moved entry, so the next emit is
+// still coalesced, and the executed call clears the pending call of the moved entry
+void testCompactionMovesPendingCoalescedCall()
+{
+	Signal signal, other;
+	Receiver x;
+	ParameterReceiver receiver;
+	SignalBase::ConnectionHandle hX = other.connect(&x, &Receiver::slot, SignalBase::DirectConnection);
+	ScopedConnection connection(signal, signal.connect(&receiver, &ParameterReceiver::slot, SignalBase::CoalescedConnection));
+
+	signal.emit(newPoolParameter(1));
+	other.disconnect(hX);
+	signal.emit(newPoolParameter(2));
+	CHECK(g_poolParameters.getNrOfUsedBlocks() == 1);
+
+	SdkSim::runTasks();
+	CHECK(receiver.m_iNrOfCalls == 1 && receiver.m_iLastValue == 2);
+
+	signal.emit(newPoolParameter(3));
+	SdkSim::runTasks();
+	CHECK(receiver.m_iNrOfCalls == 2 && receiver.m_iLastValue == 3);
+	CHECK(g_poolParameters.getNrOfUsedBlocks() == 0);
+}
+
+
+// Fills the queues of all priorities with calls, which have different parameters
+class QueueFiller
+{
+public:
+	QueueFiller()
+	{
+		for (int iPriority = SignalBase::LowPriority; iPriority <= SignalBase::HighPriority; ++iPriority)
+		{
+			m_arrayConnections[iPriority].reset(m_arraySignals[iPriority],
+			                                    m_arraySignals[iPriority].connect(&m_arrayReceivers[iPriority], &Receiver::slot,
+			                                                                      SignalBase::QueuedConnection,
+			                                                                      static_cast<SignalBase::Priority>(iPriority)));
+		}
+	}
+
+	void fill()
+	{
+		const int arraySizes[] = { MAX_NR_OF_QUEUED_SIGNALS, MAX_NR_OF_QUEUED_SIGNALS_MEDIUM_PRIORITY, MAX_NR_OF_QUEUED_SIGNALS_HIGH_PRIORITY };
+		for (int iPriority = SignalBase::LowPriority; iPriority <= SignalBase::HighPriority; ++iPriority)
+		{
+			for (int i = 0; i < arraySizes[iPriority]; ++i)
+			{
+				m_arraySignals[iPriority].emit(newParameter());
+			}
+		}
+	}
+
+	Signal m_arraySignals[SignalBase::HighPriority + 1];
+	Receiver m_arrayReceivers[SignalBase::HighPriority + 1];
+
+	// removed before the signals are destroyed
+	ScopedConnection m_arrayConnections[SignalBase::HighPriority + 1];
+};
+
+// Each signal has a queued connection, and a direct one, which emits the next signal with a new parameter
+class NestedEmits
+{
+public:
+	NestedEmits(int iDepth) : m_iDepth(iDepth), m_iLevel(0)
+	{
+		for (int i = 0; i < iDepth; ++i)
+		{
+			m_arrayConnections[2 * i].reset(m_arraySignals[i], m_arraySignals[i].connect(&m_queued, &Receiver::slot, SignalBase::QueuedConnection));
+			m_arrayConnections[2 * i + 1].reset(m_arraySignals[i],
+			                                    m_arraySignals[i].connect(this, &NestedEmits::emitNext, SignalBase::DirectConnection));
+		}
+	}
+
+	void emit()
+	{
+		m_iLevel = 0;
+		m_arraySignals[0].emit(newParameter());
+	}
+
+	void emitNext(void*)
+	{
+		++m_iLevel;
+		if (m_iLevel < m_iDepth)
+		{
+			m_arraySignals[m_iLevel].emit(newParameter());
+		}
+	}
+
+	Signal m_arraySignals[MAX_NESTING_OF_EMITS + 1];
+	Receiver m_queued;
+	int m_iDepth;
+	int m_iLevel;
+
+	// removed before the signals are destroyed
+	ScopedConnection m_arrayConnections[2 * (MAX_NESTING_OF_EMITS + 1)];
+};
+
+
+// All queues are full, and the emits are nested MAX_NESTING_OF_EMITS deep: the parameter of each level can be shared, so each queued
+// call is an ordinary overflow of the queue
+void testSharedParameterForEachNestingLevel()
+{
+	QueueFiller filler;
+	NestedEmits nested(MAX_NESTING_OF_EMITS);
+	uint32 uNrOfOverflows = SignalBase::getNrOfOverflows(SignalBase::LowPriority, SignalBase::DropNewest);
+
+	filler.fill();
+	nested.emit();
+	CHECK(SignalBase::getNrOfOverflows(SignalBase::LowPriority, SignalBase::DropNewest) == uNrOfOverflows + MAX_NESTING_OF_EMITS);
+
+	SdkSim::runTasks();
+	CHECK(filler.m_arrayReceivers[SignalBase::LowPriority].m_iNrOfCalls == MAX_NR_OF_QUEUED_SIGNALS);
+	CHECK(nested.m_queued.m_iNrOfCalls == 0);
+}
+
+
+// One level deeper the parameter can't be shared: the queued slot is handled by the overflow policy RunInline
+void testRunInlineBeyondMaxNesting()
+{
+	QueueFiller filler;
+	NestedEmits nested(MAX_NESTING_OF_EMITS + 1);
+	nested.m_arraySignals[MAX_NESTING_OF_EMITS].setOverflowPolicy(SignalBase::RunInline);
+	uint32 uNrOfOverflows = SignalBase::getNrOfOverflows(SignalBase::LowPriority, SignalBase::DropNewest);
+	uint32 uNrOfInlineCalls = SignalBase::getNrOfOverflows(SignalBase::LowPriority, SignalBase::RunInline);
+
+	filler.fill();
+	nested.emit();
+	CHECK(SignalBase::getNrOfOverflows(SignalBase::LowPriority, SignalBase::DropNewest) == uNrOfOverflows + MAX_NESTING_OF_EMITS);
+	CHECK(SignalBase::getNrOfOverflows(SignalBase::LowPriority, SignalBase::RunInline) == uNrOfInlineCalls + 1);
+	CHECK(nested.m_queued.m_iNrOfCalls == 1);
+
+	SdkSim::runTasks();
+	CHECK(filler.m_arrayReceivers[SignalBase::LowPriority].m_iNrOfCalls == MAX_NR_OF_QUEUED_SIGNALS);
+	CHECK(nested.m_queued.m_iNrOfCalls == 1);
+}
+
+
+// One level deeper the parameter can't be shared: with DropOldest the oldest queued call gives up its parameter, and the queued
+// slot replaces it
+void testDropOldestBeyondMaxNesting()
+{
+	QueueFiller filler;
+	NestedEmits nested(MAX_NESTING_OF_EMITS + 1);
+	nested.m_arraySignals[MAX_NESTING_OF_EMITS].setOverflowPolicy(SignalBase::DropOldest);
+	uint32 uNrOfDrops = SignalBase::getNrOfOverflows(SignalBase::LowPriority, SignalBase::DropOldest);
+
+	filler.fill();
+	nested.emit();
+
+	// the oldest call dropped its parameter, then its entry is reused for the new call
+	CHECK(SignalBase::getNrOfOverflows(SignalBase::LowPriority, SignalBase::DropOldest) == uNrOfDrops + 2);
+	CHECK(nested.m_queued.m_iNrOfCalls == 0);
+
+	SdkSim::runTasks();
+	CHECK(filler.m_arrayReceivers[SignalBase::LowPriority].m_iNrOfCalls == MAX_NR_OF_QUEUED_SIGNALS - 1);
+	CHECK(nested.m_queued.m_iNrOfCalls == 1);
+	CHECK(SdkSim::getNrOfPendingEvents(USER_TASK_PRIO_0) == 0);
+}
+
+// The arguments of a TypedSignal3, which are passed directly and through the queue
+class ArgumentsReceiver
+{
+public:
+	ArgumentsReceiver() : m_iNrOfCalls(0), m_uSum(0) {}
+
+	void slot(uint8 u1, uint16 u2, uint32 u3)
+	{
+		++m_iNrOfCalls;
+		m_uSum += u1 + u2 + u3;
+	}
+
+	int m_iNrOfCalls;
+	uint32 m_uSum;
+};
+
+uint32 g_uSumOfFreeSlot = 0;
+
+void freeSlot(uint8 u1, uint16 u2, uint32 u3)
+{
+	g_uSumOfFreeSlot += u1 + u2 + u3;
+}
+
+void testTypedSignalArguments()
+{
+	int iNrOfConnections = SignalBase::getNrOfConnections();
+	ArgumentsReceiver direct, once;
+	TypedSignal3<uint8, uint16, uint32> signal;
+	signal.connect(&direct, &ArgumentsReceiver::slot, SignalBase::DirectConnection);
+	signal.connectOnce(&once, &ArgumentsReceiver::slot, SignalBase::QueuedConnection);
+	signal.connect(&freeSlot, SignalBase::QueuedConnection, SignalBase::HighPriority);
+
+	signal.emit(1, 20, 300000);
+	signal.emit(2, 30, 400000);
+	CHECK(direct.m_iNrOfCalls == 2 && direct.m_uSum == 700053);
+	CHECK(once.m_iNrOfCalls == 0 && g_uSumOfFreeSlot == 0);
+
+	SdkSim::runTasks();
+	CHECK(once.m_iNrOfCalls == 1 && once.m_uSum == 300021);
+	CHECK(g_uSumOfFreeSlot == 700053);
+
+	CHECK(signal.disconnect(&direct, &ArgumentsReceiver::slot) == 1);
+	CHECK(signal.disconnect(&freeSlot) == 1);
+	CHECK(SignalBase::getNrOfConnections() == iNrOfConnections);
+}
+
+// Static connections of one signal for two receivers (a direct and a queued one), and their removal
+const SignalBase::StaticConnection arrayStaticConnections[] =
+{
+	{&Signal::staticSlot<Receiver, &Receiver::slot>, SignalBase::DirectConnection, SignalBase::LowPriority},
+	{&Signal::staticSlot<Receiver, &Receiver::slot>, SignalBase::QueuedConnection, SignalBase::MediumPriority},
+	{NULL, SignalBase::DirectConnection, SignalBase::LowPriority}
+};
+
+void testStaticConnections()
+{
+	Receiver a, b;
+	Signal signal, other;
+	CHECK(signal.connectStatic(arrayStaticConnections, &a));
+	CHECK(signal.connectStatic(arrayStaticConnections, &b));
+
+	signal.emit(NULL);
+	other.emit(NULL);
+	CHECK(a.m_iNrOfCalls == 1 && b.m_iNrOfCalls == 1);
+	SdkSim::runTasks();
+	CHECK(a.m_iNrOfCalls == 2 && b.m_iNrOfCalls == 2);
+
+	CHECK(signal.disconnectStatic(arrayStaticConnections, &a));
+	CHECK(!signal.disconnectStatic(arrayStaticConnections, &a));
+	CHECK(!other.disconnectStatic(arrayStaticConnections, &b));
+	signal.emit(NULL);
+	SdkSim::runTasks();
+	CHECK(a.m_iNrOfCalls == 2 && b.m_iNrOfCalls == 4);
+
+	// the arrays are shared by all signals
+	int iNrOfArrays = 1;
+	while (other.connectStatic(arrayStaticConnections, &a))
+	{
+		++iNrOfArrays;
+	}
+	CHECK(iNrOfArrays == MAX_NR_OF_STATIC_CONNECTION_ARRAYS);
+	while (other.disconnectStatic(arrayStaticConnections, &a))
+	{
+	}
+	CHECK(signal.disconnectStatic(arrayStaticConnections, &b));
+	other.emit(NULL);
+	signal.emit(NULL);
+	SdkSim::runTasks();
+	CHECK(a.m_iNrOfCalls == 2 && b.m_iNrOfCalls == 4);
+}
+
+
+// Signals are deleted with connections, with a pending coalesced call, a pending fan-out call and static connections: the compaction of
+// the table mustn't touch them later (the SignalAsanTest build detects it)
+void testDeletedSignals()
+{
+	int iNrOfConnections = SignalBase::getNrOfConnections();
+	Receiver a, b, c, d;
+	Signal signal;
+	SignalBase::ConnectionHandle hA = signal.connect(&a, &Receiver::slot, SignalBase::DirectConnection);
+
+	Signal* pSignal = new Signal;
+	pSignal->connect(&b, &Receiver::slot, SignalBase::DirectConnection);
+	pSignal->connect(&b, &Receiver::slot, SignalBase::CoalescedConnection);
+	pSignal->connectStatic(arrayStaticConnections, &c);
+	Signal* pFanOutSignal = new Signal;
+	pFanOutSignal->setFanOut(true);
+	pFanOutSignal->connect(&d, &Receiver::slot, SignalBase::QueuedConnection);
+	pFanOutSignal->connect(&d, &Receiver::slot, SignalBase::QueuedConnection);
+
+	pSignal->emit(newParameter());
+	pFanOutSignal->emit(newParameter());
+	delete pSignal;
+	delete pFanOutSignal;
+	CHECK(SignalBase::getNrOfConnections() == iNrOfConnections + 1);
+
+	// the last entries would be moved into the removed one
+	CHECK(signal.disconnect(hA) == 1);
+	CHECK(SignalBase::getNrOfConnections() == iNrOfConnections);
+
+	// the queued calls of the connections are still executed, the cancelled fan-out call only releases its parameter
+	SdkSim::runTasks();
+	CHECK(b.m_iNrOfCalls == 2 && c.m_iNrOfCalls == 2 && d.m_iNrOfCalls == 0);
+
+	// the static connections have been removed with the signal
+	Signal other;
+	for (int i = 0; i < MAX_NR_OF_STATIC_CONNECTION_ARRAYS; ++i)
+	{
+		CHECK(other.connectStatic(arrayStaticConnections, &a));
+	}
+	while (other.disconnectStatic(arrayStaticConnections, &a))
+	{
+	}
+}
+
+} // namespace
+
+
+int main()
+{
+	testDisconnectNextDuringEmit();
+	testDisconnectNextDuringFanOut();
+	testDisconnectNextFromSingleShotSlot();
+	testCompactionAfterRemovalsDuringEmit();
+	testCoalescedEmits();
+	testDisconnectCoalescedWithPendingCall();
+	testCompactionMovesPendingCoalescedCall();
+	testSharedParameterForEachNestingLevel();
+	testRunInlineBeyondMaxNesting();
+	testDropOldestBeyondMaxNesting();
+	testTypedSignalArguments();
+	testStaticConnections();
+	testDeletedSignals();
+
+#ifdef __SANITIZE_ADDRESS__
+	return testResult("SignalTest (AddressSanitizer)");
+#else
+	return testResult("SignalTest");
+#endif
+}
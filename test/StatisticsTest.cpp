@@ -0,0 +1,143 @@
+/* Statistics of the signals (SIGNAL_STATISTICS=1, see the Makefile): the counters of the emits and deliveries, the dropped calls and the
+   high-water mark of a full queue, and the buckets of the latency and runtime histograms, with the simulated clock.
+*/
+
+#include "Test.h"
+#include "SdkSim.h"
+#include "Signal.h"
+
+#include <string.h>
+
+using namespace Esp8266Base;
+
+namespace
+{
+
+typedef char TestNeedsStatistics[SIGNAL_STATISTICS ? 1 : -1];
+
+class Receiver
+{
+public:
+	Receiver() : m_uRuntimeUs(0), m_iNrOfCalls(0) {}
+
+	// "works" for m_uRuntimeUs
+	void slot(void*)
+	{
+		++m_iNrOfCalls;
+		SdkSim::advanceTime(m_uRuntimeUs);
+	}
+
+	uint32 m_uRuntimeUs;
+	int m_iNrOfCalls;
+};
+
+
+// Each emit counts the directly called slots and the queued ones of the signal, but not the ones of other signals
+void testDeliveryCounters()
+{
+	Signal signal, other;
+	Receiver receiver;
+	ScopedConnection connection1(signal, signal.connect(&receiver, &Receiver::slot, SignalBase::DirectConnection));
+	ScopedConnection connection2(signal, signal.connect(&receiver, &Receiver::slot, SignalBase::QueuedConnection));
+	ScopedConnection connection3(signal, signal.connect(&receiver, &Receiver::slot, SignalBase::QueuedConnection, SignalBase::MediumPriority));
+	ScopedConnection connection4(other, other.connect(&receiver, &Receiver::slot, SignalBase::DirectConnection));
+
+	for (int i = 0; i < 3; ++i)
+	{
+		signal.emit(NULL);
+	}
+	other.emit(NULL);
+	SdkSim::runTasks();
+
+	CHECK(receiver.m_iNrOfCalls == 3 * 3 + 1);
+	CHECK(signal.getNrOfEmits() == 3);
+	CHECK(signal.getNrOfDirectDeliveries() == 3);
+	CHECK(signal.getNrOfQueuedDeliveries() == 2 * 3);
+	CHECK(other.getNrOfEmits() == 1);
+	CHECK(other.getNrOfDirectDeliveries() == 1);
+	CHECK(other.getNrOfQueuedDeliveries() == 0);
+	CHECK(SignalBase::getQueueHighWaterMark(SignalBase::LowPriority) == 3);
+	CHECK(SignalBase::getQueueHighWaterMark(SignalBase::MediumPriority) == 3);
+	CHECK(SignalBase::getQueueHighWaterMark(SignalBase::HighPriority) == 0);
+}
+
+
+// The calls beyond a full queue are dropped: they are counted as overflows, but not as deliveries, and the high-water mark is the size
+// of the queue
+void testDroppedCalls()
+{
+	Signal signal;
+	Receiver receiver;
+	ScopedConnection connection(signal, signal.connect(&receiver, &Receiver::slot, SignalBase::QueuedConnection));
+	uint32 uNrOfOverflows = SignalBase::getNrOfOverflows(SignalBase::LowPriority, SignalBase::DropNewest);
+
+	for (int i = 0; i < MAX_NR_OF_QUEUED_SIGNALS + 2; ++i)
+	{
+		signal.emit(NULL);
+	}
+	CHECK(SignalBase::getNrOfOverflows(SignalBase::LowPriority, SignalBase::DropNewest) == uNrOfOverflows + 2);
+	CHECK(SignalBase::getQueueHighWaterMark(SignalBase::LowPriority) == MAX_NR_OF_QUEUED_SIGNALS);
+
+	SdkSim::runTasks();
+	CHECK(receiver.m_iNrOfCalls == MAX_NR_OF_QUEUED_SIGNALS);
+	CHECK(signal.getNrOfEmits() == MAX_NR_OF_QUEUED_SIGNALS + 2);
+	CHECK(signal.getNrOfQueuedDeliveries() == MAX_NR_OF_QUEUED_SIGNALS);
+	CHECK(SignalBase::getQueueHighWaterMark(SignalBase::LowPriority) == MAX_NR_OF_QUEUED_SIGNALS);
+}
+
+
+// The bucket i of a histogram counts the durations below (16 << 2*i) us, and the last one all the longer ones
+void testHistograms()
+{
+	uint32 arrayLatencies[SignalBase::NR_OF_HISTOGRAM_BUCKETS];
+	uint32 arrayRuntimes[SignalBase::NR_OF_HISTOGRAM_BUCKETS];
+	memcpy(arrayLatencies, SignalBase::getLatencyHistogram(), sizeof(arrayLatencies));
+	memcpy(arrayRuntimes, SignalBase::getRuntimeHistogram(), sizeof(arrayRuntimes));
+
+	Signal direct, queued;
+	Receiver fast, slow;
+	fast.m_uRuntimeUs = 10;
+	slow.m_uRuntimeUs = 5000;
+	ScopedConnection connection1(direct, direct.connect(&fast, &Receiver::slot, SignalBase::DirectConnection));
+	ScopedConnection connection2(queued, queued.connect(&slow, &Receiver::slot, SignalBase::QueuedConnection));
+
+	// runtime 10 us: bucket 0
+	direct.emit(NULL);
+
+	// latency 100 us: bucket 2 (64..255 us), runtime 5000 us: bucket 5 (4096..16383 us)
+	queued.emit(NULL);
+	SdkSim::advanceTime(100);
+	SdkSim::runTasks();
+
+	// latency 1 s: the last bucket
+	queued.emit(NULL);
+	SdkSim::advanceTime(1000 * 1000);
+	SdkSim::runTasks();
+
+	const uint32* pLatencies = SignalBase::getLatencyHistogram();
+	const uint32* pRuntimes = SignalBase::getRuntimeHistogram();
+	for (int i = 0; i < SignalBase::NR_OF_HISTOGRAM_BUCKETS; ++i)
+	{
+		uint32 uNewLatencies = pLatencies[i] - arrayLatencies[i];
+		uint32 uNewRuntimes = pRuntimes[i] - arrayRuntimes[i];
+		CHECK(uNewLatencies == ((2 == i || SignalBase::NR_OF_HISTOGRAM_BUCKETS - 1 == i) ? 1u : 0u));
+		CHECK(uNewRuntimes == (0 == i ? 1u : (5 == i ? 2u : 0u)));
+	}
+
+	const SignalBase* pSlowestSignal = NULL;
+	CHECK(SignalBase::getMaxRuntime(&pSlowestSignal) == 5000);
+	CHECK(pSlowestSignal == &queued);
+}
+
+} // namespace
+
+
+int main()
+{
+	testDeliveryCounters();
+	testDroppedCalls();
+	testHistograms();
+	SignalBase::printStatistics();
+
+	return testResult("StatisticsTest");
+}
@@ -0,0 +1,34 @@
+#ifndef TEST_H_INCLUDED
+#define TEST_H_INCLUDED
+
+#include <stdio.h>
+
+/* Minimal checks of the host tests: a failed CHECK() prints its location and the test continues, testResult() returns the exit code of
+   the test program.
+*/
+
+static int g_iNrOfFailedChecks = 0;
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			++g_iNrOfFailedChecks; \
+		} \
+	} while (0)
+
+inline int testResult(const char* strTestName)
+{
+	if (0 == g_iNrOfFailedChecks)
+	{
+		printf("%s: OK\n", strTestName);
+		return 0;
+	}
+
+	printf("%s: %d checks failed\n", strTestName, g_iNrOfFailedChecks);
+	return 1;
+}
+
+#endif
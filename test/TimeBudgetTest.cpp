@@ -0,0 +1,146 @@
+/* Processing of the queued signals with QUEUED_SIGNALS_TIME_BUDGET_US: one run of the task calls the pending slots, until the time budget
+   is used up, then it posts a new event for the rest. Only one INVOKE_SLOT event of a priority is pending at a time, so the event queue
+   can't overflow. The test is built with QUEUED_SIGNALS_TIME_BUDGET_US=2000 (see the Makefile).
+*/
+
+#include "Test.h"
+#include "SdkSim.h"
+#include "Signal.h"
+
+extern "C"
+{
+	#include <user_interface.h>
+}
+
+using namespace Esp8266Base;
+
+namespace
+{
+
+// The budget must be longer than a few short slots, and shorter than the long ones below
+typedef char TestNeedsTimeBudget[QUEUED_SIGNALS_TIME_BUDGET_US >= 1000 ? 1 : -1];
+
+const uint32 SHORT_SLOT_US = 100;
+const uint32 LONG_SLOT_US = QUEUED_SIGNALS_TIME_BUDGET_US * 2 / 5;
+
+class Receiver
+{
+public:
+	Receiver() : m_pSignal(NULL), m_uRuntimeUs(0), m_iNrOfCalls(0) {}
+
+	// "works" for m_uRuntimeUs
+	void slot(void*)
+	{
+		++m_iNrOfCalls;
+		SdkSim::advanceTime(m_uRuntimeUs);
+	}
+
+	// emits m_pSignal once (a queued slot, which queues an other one)
+	void emittingSlot(void*)
+	{
+		++m_iNrOfCalls;
+		if (NULL != m_pSignal)
+		{
+			m_pSignal->emit(NULL);
+			m_pSignal = NULL;
+		}
+	}
+
+	Signal* m_pSignal;
+	uint32 m_uRuntimeUs;
+	int m_iNrOfCalls;
+};
+
+
+// All slots fit into the budget: one event, and one run of the task calls all of them
+void testDrainInOneRun()
+{
+	Signal signal;
+	Receiver receiver;
+	receiver.m_uRuntimeUs = SHORT_SLOT_US;
+	ScopedConnection connection(signal, signal.connect(&receiver, &Receiver::slot, SignalBase::QueuedConnection));
+
+	for (int i = 0; i < MAX_NR_OF_QUEUED_SIGNALS; ++i)
+	{
+		signal.emit(NULL);
+	}
+	CHECK(SdkSim::getNrOfPendingEvents(USER_TASK_PRIO_0) == 1);
+
+	CHECK(SdkSim::runTask());
+	CHECK(receiver.m_iNrOfCalls == MAX_NR_OF_QUEUED_SIGNALS);
+	CHECK(SdkSim::getNrOfPendingEvents(USER_TASK_PRIO_0) == 0);
+}
+
+
+// The slots don't fit into the budget: the run stops after the slot, which used up the budget, and posts a new event for the rest
+void testRepostAfterBudget()
+{
+	Signal signal;
+	Receiver receiver;
+	receiver.m_uRuntimeUs = LONG_SLOT_US;
+	ScopedConnection connection(signal, signal.connect(&receiver, &Receiver::slot, SignalBase::QueuedConnection));
+
+	for (int i = 0; i < 6; ++i)
+	{
+		signal.emit(NULL);
+	}
+	CHECK(SdkSim::getNrOfPendingEvents(USER_TASK_PRIO_0) == 1);
+
+	// 3 slots of 2/5 budget: the third one starts within the budget, and ends after it
+	CHECK(SdkSim::runTask());
+	CHECK(receiver.m_iNrOfCalls == 3);
+	CHECK(SdkSim::getNrOfPendingEvents(USER_TASK_PRIO_0) == 1);
+
+	CHECK(SdkSim::runTask());
+	CHECK(receiver.m_iNrOfCalls == 6);
+	CHECK(SdkSim::getNrOfPendingEvents(USER_TASK_PRIO_0) == 0);
+}
+
+
+// A queued slot emits a queued signal: the flag of the posted event is cleared before the slots are called, so the new call gets its own
+// event, and an event, which finds its calls already done, does nothing. Each priority has its own event.
+void testSinglePostedEvent()
+{
+	Signal signal, next, high;
+	Receiver emitting, receiver, highReceiver;
+	emitting.m_pSignal = &next;
+	ScopedConnection connection1(signal, signal.connect(&emitting, &Receiver::emittingSlot, SignalBase::QueuedConnection));
+	ScopedConnection connection2(next, next.connect(&receiver, &Receiver::slot, SignalBase::QueuedConnection));
+	ScopedConnection connection3(high, high.connect(&highReceiver, &Receiver::slot, SignalBase::QueuedConnection, SignalBase::HighPriority));
+
+	signal.emit(NULL);
+	signal.emit(NULL);
+	high.emit(NULL);
+	CHECK(SdkSim::getNrOfPendingEvents(USER_TASK_PRIO_0) == 1);
+	CHECK(SdkSim::getNrOfPendingEvents(USER_TASK_PRIO_2) == 1);
+
+	// the high priority runs first, then the low one calls both emitting slots and the slot queued by the first one
+	CHECK(SdkSim::runTask());
+	CHECK(highReceiver.m_iNrOfCalls == 1);
+	CHECK(SdkSim::runTask());
+	CHECK(emitting.m_iNrOfCalls == 2);
+	CHECK(receiver.m_iNrOfCalls == 1);
+	CHECK(SdkSim::getNrOfPendingEvents(USER_TASK_PRIO_0) == 1);
+
+	CHECK(SdkSim::runTask());
+	CHECK(receiver.m_iNrOfCalls == 1);
+	CHECK(SdkSim::getNrOfPendingEvents(USER_TASK_PRIO_0) == 0);
+
+	// the flag has been cleared by the last run too, so the next emit posts again
+	next.emit(NULL);
+	CHECK(SdkSim::getNrOfPendingEvents(USER_TASK_PRIO_0) == 1);
+	SdkSim::runTasks();
+	CHECK(receiver.m_iNrOfCalls == 2);
+}
+
+} // namespace
+
+
+int main()
+{
+	testDrainInOneRun();
+	testRepostAfterBudget();
+	testSinglePostedEvent();
+
+	return testResult("TimeBudgetTest");
+}
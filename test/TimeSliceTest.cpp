@@ -0,0 +1,144 @@
+/* SignalBase::yieldIfTimeSliceOver(): a long queued job is split into parts, which run at most QUEUED_SLOT_TIME_SLICE_US without
+   interruption, and the other queued slots run in between. A direct slot of a signal emitted by a queued slot can't yield the queued
+   slot.
+*/
+
+#include "Test.h"
+#include "SdkSim.h"
+#include "Signal.h"
+
+using namespace Esp8266Base;
+
+namespace
+{
+
+const int NR_OF_STEPS = 40;
+const uint32 STEP_RUNTIME_US = 700;
+
+class Job
+{
+public:
+	Job() : m_iNextStep(0), m_iNrOfCalls(0), m_uMaxUninterruptedUs(0) {}
+
+	// does the steps of the job, until the next step wouldn't fit into the time slice
+	void run(void*)
+	{
+		++m_iNrOfCalls;
+		uint64 uStartTime = SdkSim::getTime();
+		while (m_iNextStep < NR_OF_STEPS)
+		{
+			SdkSim::advanceTime(STEP_RUNTIME_US);
+			++m_iNextStep;
+			if (m_iNextStep < NR_OF_STEPS && SignalBase::yieldIfTimeSliceOver(QUEUED_SLOT_TIME_SLICE_US - STEP_RUNTIME_US))
+			{
+				break;
+			}
+		}
+
+		uint64 uRuntime = SdkSim::getTime() - uStartTime;
+		if (uRuntime > m_uMaxUninterruptedUs)
+		{
+			m_uMaxUninterruptedUs = uRuntime;
+		}
+	}
+
+	int m_iNextStep;
+	int m_iNrOfCalls;
+	uint64 m_uMaxUninterruptedUs;
+};
+
+class Receiver
+{
+public:
+	Receiver() : m_iNrOfCalls(0), m_iNrOfYields(0) {}
+
+	void slot(void*)
+	{
+		++m_iNrOfCalls;
+	}
+
+	// works longer than a time slice, and tries to yield
+	void slowSlot(void*)
+	{
+		++m_iNrOfCalls;
+		SdkSim::advanceTime(2 * QUEUED_SLOT_TIME_SLICE_US);
+		if (SignalBase::yieldIfTimeSliceOver())
+		{
+			++m_iNrOfYields;
+		}
+	}
+
+	int m_iNrOfCalls;
+	int m_iNrOfYields;
+};
+
+// A queued slot, which emits a signal with a slow direct slot
+class Outer
+{
+public:
+	Outer() : m_iNrOfCalls(0)
+	{
+		m_signalNested.connect(&m_nested, &Receiver::slowSlot, SignalBase::DirectConnection);
+	}
+
+	void slot(void*)
+	{
+		++m_iNrOfCalls;
+		m_signalNested.emit(NULL);
+	}
+
+	Signal m_signalNested;
+	Receiver m_nested;
+	int m_iNrOfCalls;
+};
+
+
+void testMaxUninterruptedRuntime()
+{
+	Signal signalJob, signalOther;
+	Job job;
+	Receiver other;
+	signalJob.connect(&job, &Job::run, SignalBase::QueuedConnection);
+	signalOther.connect(&other, &Receiver::slot, SignalBase::QueuedConnection);
+
+	signalJob.emit(NULL);
+	signalOther.emit(NULL);
+	SdkSim::runTasks();
+
+	printf("job of %u us: %d parts, max %u us uninterrupted (time slice %u us)\n", NR_OF_STEPS * STEP_RUNTIME_US, job.m_iNrOfCalls,
+	       (uint32)job.m_uMaxUninterruptedUs, QUEUED_SLOT_TIME_SLICE_US);
+	CHECK(job.m_iNextStep == NR_OF_STEPS);
+	CHECK(job.m_uMaxUninterruptedUs <= QUEUED_SLOT_TIME_SLICE_US);
+	CHECK(job.m_iNrOfCalls > (int)(NR_OF_STEPS * STEP_RUNTIME_US / QUEUED_SLOT_TIME_SLICE_US));
+	CHECK(other.m_iNrOfCalls == 1);
+}
+
+
+void testNestedDirectSlotDoesntYield()
+{
+	Signal signalOuter;
+	Outer outer;
+	signalOuter.connect(&outer, &Outer::slot, SignalBase::QueuedConnection);
+
+	signalOuter.emit(NULL);
+
+	// the outer slot would be queued again after each call, if the nested slot could yield it
+	for (int i = 0; i < 10 && SdkSim::runTask(); ++i)
+	{
+	}
+	CHECK(outer.m_iNrOfCalls == 1);
+	CHECK(outer.m_nested.m_iNrOfCalls == 1);
+	CHECK(outer.m_nested.m_iNrOfYields == 0);
+	CHECK(SdkSim::getNrOfPendingEvents(USER_TASK_PRIO_0) == 0);
+}
+
+} // namespace
+
+
+int main()
+{
+	testMaxUninterruptedRuntime();
+	testNestedDirectSlotDoesntYield();
+
+	return testResult("TimeSliceTest");
+}
@@ -0,0 +1,347 @@
+/* Timer: the deadlines of the repeating and long timers, the measured jitter, startUs(), and the records of singleShot(), with the
+   simulated clock. The test is built for each backend, with and without USE_US_TIMER (see the Makefile), and the expected expiries are
+   the same, except for the resolution of the timer wheel.
+*/
+
+#include "Test.h"
+#include "SdkSim.h"
+#include "Timer.h"
+
+using namespace Esp8266Base;
+
+namespace
+{
+
+// The latest expiry after a deadline: a tick of the wheel, or the rounding of os_timer_arm() to milliseconds
+#if TIMER_WHEEL
+const uint64 RESOLUTION_US = TIMER_WHEEL_TICK_MS * 1000;
+#else
+const uint64 RESOLUTION_US = 1000;
+#endif
+
+class Receiver
+{
+public:
+	Receiver() : m_iNrOfCalls(0), m_uLastCallTime(0) {}
+
+	void slot(void*)
+	{
+		++m_iNrOfCalls;
+		m_uLastCallTime = SdkSim::getTime();
+	}
+
+	int m_iNrOfCalls;
+	uint64 m_uLastCallTime;
+};
+
+
+// A repeating timer, whose period isn't a multiple of the tick, expires with its own period on average
+void testRepeatingPeriod()
+{
+	Timer timer;
+	Receiver receiver;
+	timer.timeOut.connect(&receiver, &Receiver::slot, SignalBase::DirectConnection);
+
+	uint64 uStartTime = SdkSim::getTime();
+	timer.start(15, true);
+	SdkSim::runUntil(uStartTime + 3000 * 1000);
+	timer.stop();
+
+	CHECK(receiver.m_iNrOfCalls == 200);
+	CHECK(receiver.m_uLastCallTime >= uStartTime + 3000 * 1000 - RESOLUTION_US);
+	CHECK(timer.getMaxJitterUs() <= RESOLUTION_US);
+}
+
+
+// The 1000th expiry of a periodic timer is at 1000 periods after the start, and not later
+void testPeriodicDoesntDrift()
+{
+	Timer timer;
+	Receiver receiver;
+	timer.timeOut.connect(&receiver, &Receiver::slot, SignalBase::DirectConnection);
+
+	uint64 uStartTime = SdkSim::getTime();
+	timer.startPeriodic(146);
+	while (receiver.m_iNrOfCalls < 1000)
+	{
+		SdkSim::runUntil(SdkSim::getTime() + 146 * 1000);
+	}
+	timer.stop();
+
+	CHECK(receiver.m_uLastCallTime >= uStartTime + 1000 * 146 * 1000);
+	CHECK(receiver.m_uLastCallTime <= uStartTime + 1000 * 146 * 1000 + RESOLUTION_US);
+	CHECK(timer.getMaxJitterUs() <= RESOLUTION_US);
+	CHECK(timer.getNrOfOverruns() == 0);
+}
+
+
+// Periodic timers longer than the overflow of a signed 32 bit microsecond count (35.8 minutes), and of system_get_time() (71.6 minutes)
+void testLongPeriods()
+{
+	const int arrayPeriodsMs[] = { 40 * 60 * 1000, 3 * 60 * 60 * 1000 };
+	for (unsigned int i = 0; i < sizeof(arrayPeriodsMs) / sizeof(arrayPeriodsMs[0]); ++i)
+	{
+		uint64 uPeriodUs = (uint64)arrayPeriodsMs[i] * 1000;
+		Timer timer;
+		Receiver receiver;
+		timer.timeOut.connect(&receiver, &Receiver::slot, SignalBase::DirectConnection);
+
+		uint64 uStartTime = SdkSim::getTime();
+		timer.startPeriodic(arrayPeriodsMs[i]);
+		SdkSim::runUntil(uStartTime + uPeriodUs - RESOLUTION_US);
+		CHECK(receiver.m_iNrOfCalls == 0);
+
+		SdkSim::runUntil(uStartTime + 3 * uPeriodUs + RESOLUTION_US);
+		timer.stop();
+		CHECK(receiver.m_iNrOfCalls == 3);
+		CHECK(receiver.m_uLastCallTime >= uStartTime + 3 * uPeriodUs);
+		CHECK(timer.getMaxJitterUs() <= RESOLUTION_US);
+		CHECK(timer.getNrOfOverruns() == 0);
+	}
+}
+
+
+// Records each expiry of a timer with its jitter, and the first slot call works 350 ms (3.5 periods of 100 ms)
+class OverrunReceiver
+{
+public:
+	enum { MAX_NR_OF_CALLS = 16 };
+
+	OverrunReceiver(Timer& timer) : m_timer(timer), m_iNrOfCalls(0) {}
+
+	void slot(void*)
+	{
+		if (m_iNrOfCalls < MAX_NR_OF_CALLS)
+		{
+			m_arrayCallTimes[m_iNrOfCalls] = SdkSim::getTime();
+			m_arrayJittersUs[m_iNrOfCalls] = m_timer.getLastJitterUs();
+		}
+		++m_iNrOfCalls;
+		if (1 == m_iNrOfCalls)
+		{
+			SdkSim::advanceTime(350 * 1000);
+		}
+	}
+
+	Timer& m_timer;
+	int m_iNrOfCalls;
+	uint64 m_arrayCallTimes[MAX_NR_OF_CALLS];
+	sint32 m_arrayJittersUs[MAX_NR_OF_CALLS];
+};
+
+
+// A slot runs past the deadlines at 200 and 300 ms: SkipMissedPeriods expires once late (measured from the deadline at 200 ms), and
+// continues at 500 ms
+void testSkipMissedPeriods()
+{
+	Timer timer;
+	OverrunReceiver receiver(timer);
+	timer.timeOut.connect(&receiver, &OverrunReceiver::slot, SignalBase::DirectConnection);
+
+	uint64 uStartTime = SdkSim::getTime();
+	timer.startPeriodic(100, Timer::SkipMissedPeriods);
+	SdkSim::runUntil(uStartTime + 1000 * 1000 + RESOLUTION_US);
+	timer.stop();
+
+	// 100, 450 (late), 500, 600, ... 1000 ms
+	CHECK(receiver.m_iNrOfCalls == 8);
+	CHECK(timer.getNrOfOverruns() == 2);
+	CHECK(receiver.m_arrayCallTimes[1] >= uStartTime + 450 * 1000 && receiver.m_arrayCallTimes[1] <= uStartTime + 450 * 1000 + RESOLUTION_US);
+	CHECK(receiver.m_arrayJittersUs[1] >= 250 * 1000 && receiver.m_arrayJittersUs[1] <= 250 * 1000 + (sint32)RESOLUTION_US);
+	CHECK(receiver.m_arrayCallTimes[2] >= uStartTime + 500 * 1000 && receiver.m_arrayCallTimes[2] <= uStartTime + 500 * 1000 + RESOLUTION_US);
+	CHECK(receiver.m_arrayJittersUs[2] >= 0 && receiver.m_arrayJittersUs[2] <= (sint32)RESOLUTION_US);
+	CHECK(timer.getMaxJitterUs() == (uint32)receiver.m_arrayJittersUs[1]);
+}
+
+
+// The same with CatchUpMissedPeriods: the missed periods expire immediately one after the other, each measured from its own deadline
+void testCatchUpMissedPeriods()
+{
+	Timer timer;
+	OverrunReceiver receiver(timer);
+	timer.timeOut.connect(&receiver, &OverrunReceiver::slot, SignalBase::DirectConnection);
+
+	uint64 uStartTime = SdkSim::getTime();
+	timer.startPeriodic(100, Timer::CatchUpMissedPeriods);
+	SdkSim::runUntil(uStartTime + 1000 * 1000 + RESOLUTION_US);
+	timer.stop();
+
+	// 100, 450 (3 times, for 200, 300 and 400 ms), 500, 600, ... 1000 ms
+	CHECK(receiver.m_iNrOfCalls == 10);
+	CHECK(timer.getNrOfOverruns() == 2);
+	for (int i = 1; i <= 3; ++i)
+	{
+		CHECK(receiver.m_arrayCallTimes[i] == receiver.m_arrayCallTimes[1]);
+		CHECK(receiver.m_arrayJittersUs[i] == (sint32)(receiver.m_arrayCallTimes[1] - uStartTime) - (i + 1) * 100 * 1000);
+	}
+	CHECK(receiver.m_arrayJittersUs[1] >= 250 * 1000 && receiver.m_arrayJittersUs[1] <= 250 * 1000 + (sint32)RESOLUTION_US);
+	CHECK(receiver.m_arrayCallTimes[4] >= uStartTime + 500 * 1000 && receiver.m_arrayCallTimes[4] <= uStartTime + 500 * 1000 + RESOLUTION_US);
+	CHECK(timer.getMaxJitterUs() == (uint32)receiver.m_arrayJittersUs[1]);
+}
+
+
+// Single-shot timers with slack, longer than 35.8 minutes: they wake up together at the end of the earlier slack window, not before
+void testLongSingleShotsWithSlack()
+{
+	const uint64 DELAY_US = (uint64)40 * 60 * 1000 * 1000;
+	Timer timer1, timer2;
+	Receiver receiver1, receiver2;
+	timer1.timeOut.connect(&receiver1, &Receiver::slot, SignalBase::DirectConnection);
+	timer2.timeOut.connect(&receiver2, &Receiver::slot, SignalBase::DirectConnection);
+
+	uint64 uStartTime = SdkSim::getTime();
+	timer1.start(40 * 60 * 1000, false, NULL, 100);
+	timer2.start(40 * 60 * 1000 + 50, false, NULL, 100);
+	SdkSim::runUntil(uStartTime + DELAY_US - RESOLUTION_US);
+	CHECK(receiver1.m_iNrOfCalls == 0);
+	CHECK(receiver2.m_iNrOfCalls == 0);
+
+	SdkSim::runUntil(uStartTime + DELAY_US + 200 * 1000);
+	CHECK(receiver1.m_iNrOfCalls == 1);
+	CHECK(receiver2.m_iNrOfCalls == 1);
+	CHECK(receiver1.m_uLastCallTime >= uStartTime + DELAY_US);
+	CHECK(receiver1.m_uLastCallTime <= uStartTime + DELAY_US + 100 * 1000 + RESOLUTION_US);
+	CHECK(receiver2.m_uLastCallTime == receiver1.m_uLastCallTime);
+}
+
+
+// The jitter is the delay of the os_timer callback (and the rounding to the tick of the wheel)
+void testJitter()
+{
+	Timer timer;
+	Receiver receiver;
+	timer.timeOut.connect(&receiver, &Receiver::slot, SignalBase::DirectConnection);
+
+	SdkSim::setTimerLatencyUs(300);
+	uint64 uStartTime = SdkSim::getTime();
+	timer.start(20);
+	SdkSim::runUntil(uStartTime + 100 * 1000);
+	SdkSim::setTimerLatencyUs(0);
+
+	CHECK(receiver.m_iNrOfCalls == 1);
+	CHECK(timer.getLastJitterUs() >= 300);
+	CHECK(timer.getLastJitterUs() <= 300 + (sint32)(TIMER_WHEEL ? RESOLUTION_US : 0));
+	CHECK(receiver.m_uLastCallTime == uStartTime + 20 * 1000 + timer.getLastJitterUs());
+	CHECK(timer.getMaxJitterUs() == (uint32)timer.getLastJitterUs());
+}
+
+
+// singleShot() calls the slot once, after the delay, and the record goes back to the pool before the call
+void testSingleShot()
+{
+	Receiver receiver;
+	const MemoryPoolBase& pool = Timer::getSingleShotPool();
+
+	uint64 uStartTime = SdkSim::getTime();
+	CHECK(Timer::singleShot(100, &receiver, &Receiver::slot));
+	CHECK(pool.getNrOfUsedBlocks() == 1);
+	SdkSim::runUntil(uStartTime + 99 * 1000);
+	CHECK(receiver.m_iNrOfCalls == 0);
+
+	SdkSim::runUntil(uStartTime + 1000 * 1000);
+	CHECK(receiver.m_iNrOfCalls == 1);
+	CHECK(receiver.m_uLastCallTime >= uStartTime + 100 * 1000);
+	CHECK(receiver.m_uLastCallTime <= uStartTime + 100 * 1000 + 1000);
+	CHECK(pool.getNrOfUsedBlocks() == 0);
+	CHECK(Timer::cancelSingleShots(&receiver, &Receiver::slot) == 0);
+}
+
+
+// cancelSingleShots() cancels only the calls of its slot, and returns their number
+void testCancelSingleShots()
+{
+	Receiver receiver1, receiver2;
+	const MemoryPoolBase& pool = Timer::getSingleShotPool();
+
+	uint64 uStartTime = SdkSim::getTime();
+	CHECK(Timer::singleShot(10, &receiver1, &Receiver::slot));
+	CHECK(Timer::singleShot(20, &receiver2, &Receiver::slot));
+	CHECK(Timer::singleShot(30, &receiver1, &Receiver::slot));
+	CHECK(pool.getNrOfUsedBlocks() == 3);
+
+	CHECK(Timer::cancelSingleShots(&receiver1, &Receiver::slot) == 2);
+	CHECK(pool.getNrOfUsedBlocks() == 1);
+	SdkSim::runUntil(uStartTime + 100 * 1000);
+	CHECK(receiver1.m_iNrOfCalls == 0);
+	CHECK(receiver2.m_iNrOfCalls == 1);
+	CHECK(pool.getNrOfUsedBlocks() == 0);
+	CHECK(Timer::cancelSingleShots(&receiver2, &Receiver::slot) == 0);
+}
+
+
+// singleShot() returns false, if all NR_OF_SINGLE_SHOT_TIMERS records are pending, and the pool counts the failure
+void testSingleShotPoolExhausted()
+{
+	Receiver receiver;
+	const MemoryPoolBase& pool = Timer::getSingleShotPool();
+	unsigned int uNrOfFailures = pool.getNrOfAllocationFailures();
+
+	uint64 uStartTime = SdkSim::getTime();
+	for (int i = 0; i < NR_OF_SINGLE_SHOT_TIMERS; ++i)
+	{
+		CHECK(Timer::singleShot(10 + i, &receiver, &Receiver::slot));
+	}
+	CHECK(!Timer::singleShot(50, &receiver, &Receiver::slot));
+	CHECK(pool.getNrOfUsedBlocks() == NR_OF_SINGLE_SHOT_TIMERS);
+	CHECK(pool.getHighWaterMark() == NR_OF_SINGLE_SHOT_TIMERS);
+	CHECK(pool.getNrOfAllocationFailures() == uNrOfFailures + 1);
+
+	SdkSim::runUntil(uStartTime + 100 * 1000);
+	CHECK(receiver.m_iNrOfCalls == NR_OF_SINGLE_SHOT_TIMERS);
+	CHECK(pool.getNrOfUsedBlocks() == 0);
+	CHECK(Timer::singleShot(10, &receiver, &Receiver::slot));
+	SdkSim::runUntil(uStartTime + 200 * 1000);
+	CHECK(receiver.m_iNrOfCalls == NR_OF_SINGLE_SHOT_TIMERS + 1);
+	CHECK(pool.getNrOfAllocationFailures() == uNrOfFailures + 1);
+}
+
+
+#ifdef USE_US_TIMER
+// startUs() uses the own os_timer with microseconds (also with TIMER_WHEEL), so it expires without rounding
+void testStartUs()
+{
+	Timer timer;
+	Receiver receiver;
+	timer.timeOut.connect(&receiver, &Receiver::slot, SignalBase::DirectConnection);
+
+	uint64 uStartTime = SdkSim::getTime();
+	timer.startUs(1500);
+	SdkSim::runUntil(uStartTime + 10 * 1000);
+	CHECK(receiver.m_iNrOfCalls == 1);
+	CHECK(receiver.m_uLastCallTime == uStartTime + 1500);
+	CHECK(timer.getLastJitterUs() == 0);
+
+	SdkSim::setTimerLatencyUs(30);
+	uStartTime = SdkSim::getTime();
+	timer.startUs(250, true);
+	SdkSim::runUntil(uStartTime + 10 * 1000 + 100);
+	timer.stop();
+	SdkSim::setTimerLatencyUs(0);
+	CHECK(receiver.m_iNrOfCalls == 1 + 40);
+	CHECK(timer.getLastJitterUs() == 30);
+	CHECK(timer.getMaxJitterUs() == 30);
+}
+#endif
+
+} // namespace
+
+
+int main()
+{
+	testRepeatingPeriod();
+	testPeriodicDoesntDrift();
+	testLongPeriods();
+	testLongSingleShotsWithSlack();
+	testJitter();
+	testSkipMissedPeriods();
+	testCatchUpMissedPeriods();
+	testSingleShot();
+	testCancelSingleShots();
+	testSingleShotPoolExhausted();
+#ifdef USE_US_TIMER
+	testStartUs();
+	return testResult(TIMER_WHEEL ? "TimerTest (TIMER_WHEEL, USE_US_TIMER)" : "TimerTest (USE_US_TIMER)");
+#else
+	return testResult(TIMER_WHEEL ? "TimerTest (TIMER_WHEEL)" : "TimerTest");
+#endif
+}
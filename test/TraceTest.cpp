@@ -0,0 +1,134 @@
+/* Trace: the records of the ring after a wraparound, their layout in the output of Trace::dump(), and the events recorded by Signal.
+   The test is built with TRACE_BUFFER_SIZE=16, and it writes the dumps to TRACE_LOG_FILE, which DecodeTraceTest.py decodes with
+   tools/decode_trace.py (see the Makefile).
+*/
+
+#include "Test.h"
+#include "SdkSim.h"
+#include "Signal.h"
+#include "Trace.h"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace Esp8266Base;
+
+namespace
+{
+
+typedef char TestNeedsTraceBuffer[TRACE_BUFFER_SIZE >= 4 ? 1 : -1];
+
+// the number of records, which are overwritten after the wraparound
+const int NR_OF_LOST_RECORDS = 5;
+
+// the output of the dumps, which is written to TRACE_LOG_FILE too
+char g_bufferLog[4096];
+unsigned int g_uLogLength = 0;
+
+// Returns the output of Trace::dump(), and appends it to the log
+const char* dump()
+{
+	static char buffer[2048];
+	SdkSim::captureUart(buffer, sizeof(buffer));
+	Trace::dump();
+	SdkSim::captureUart(NULL, 0);
+
+	CHECK(g_uLogLength + strlen(buffer) < sizeof(g_bufferLog));
+	g_uLogLength += snprintf(g_bufferLog + g_uLogLength, sizeof(g_bufferLog) - g_uLogLength, "%s", buffer);
+	return buffer;
+}
+
+
+class Receiver
+{
+public:
+	void slot(void*) {}
+};
+
+
+// TRACE_BUFFER_SIZE + NR_OF_LOST_RECORDS records: the dump starts with the oldest one, which hasn't been overwritten, and each line
+// has the timestamp, the event, the object and the argument in hex
+void testWraparound()
+{
+	Trace::clear();
+	uint32 arrayTimestamps[TRACE_BUFFER_SIZE + NR_OF_LOST_RECORDS];
+	for (int i = 0; i < TRACE_BUFFER_SIZE + NR_OF_LOST_RECORDS; ++i)
+	{
+		SdkSim::advanceTime(10);
+		arrayTimestamps[i] = (uint32)SdkSim::getTime();
+		Trace::record(Trace::FirstUserEvent + i, (const void*)(size_t)(0x3ffe8000 + 4 * i), 0xa0000000 + i);
+	}
+
+	char bufferExpected[2048];
+	int iLength = sprintf(bufferExpected, "TRACE BEGIN %d\n", NR_OF_LOST_RECORDS);
+	for (int i = NR_OF_LOST_RECORDS; i < TRACE_BUFFER_SIZE + NR_OF_LOST_RECORDS; ++i)
+	{
+		iLength += sprintf(bufferExpected + iLength, "TR %08x%08x%08x%08x\n", arrayTimestamps[i], Trace::FirstUserEvent + i,
+		                   0x3ffe8000 + 4 * i, 0xa0000000 + i);
+	}
+	sprintf(bufferExpected + iLength, "TRACE END\n");
+	CHECK(0 == strcmp(dump(), bufferExpected));
+
+	// the dump doesn't clear the ring
+	CHECK(0 == strcmp(dump(), bufferExpected));
+}
+
+
+// clear() removes the records, and the ring is filled from its beginning again
+void testClear()
+{
+	Trace::clear();
+	CHECK(0 == strcmp(dump(), "TRACE BEGIN 0\nTRACE END\n"));
+
+	uint32 uTimestamp = (uint32)SdkSim::getTime();
+	Trace::record(Trace::EspNowSent, NULL, 1);
+	char bufferExpected[128];
+	sprintf(bufferExpected, "TRACE BEGIN 0\nTR %08x%08x%08x%08x\nTRACE END\n", uTimestamp, Trace::EspNowSent, 0, 1);
+	CHECK(0 == strcmp(dump(), bufferExpected));
+}
+
+
+// A queued emit records the emit and the run of the task of the low priority; the dump is the last one in the log, so the decoder
+// test checks its names
+void testSignalEvents()
+{
+	Signal signal;
+	Receiver receiver;
+	ScopedConnection connection(signal, signal.connect(&receiver, &Receiver::slot, SignalBase::QueuedConnection));
+
+	Trace::clear();
+	signal.emit(NULL);
+	SdkSim::advanceTime(100);
+	SdkSim::runTasks();
+	Trace::record(Trace::TimerExpired, NULL, (uint32)-20);
+
+	const char* pDump = dump();
+	char bufferLine[64];
+	sprintf(bufferLine, "%08x%08x%08x\n", Trace::SignalEmit, (uint32)(size_t)&signal, 0);
+	CHECK(NULL != strstr(pDump, bufferLine));
+	sprintf(bufferLine, "%08x%08x%08x\n", Trace::TaskInvokeSlotStart, 0, 1928 << 16);
+	CHECK(NULL != strstr(pDump, bufferLine));
+	sprintf(bufferLine, "%08x%08x%08x\n", Trace::TaskInvokeSlotEnd, 0, 1928 << 16);
+	CHECK(NULL != strstr(pDump, bufferLine));
+	CHECK(0 == strncmp(pDump, "TRACE BEGIN 0\n", 14));
+}
+
+} // namespace
+
+
+int main()
+{
+	testWraparound();
+	testClear();
+	testSignalEvents();
+
+	FILE* pFile = fopen(TRACE_LOG_FILE, "w");
+	CHECK(NULL != pFile);
+	if (NULL != pFile)
+	{
+		fputs(g_bufferLog, pFile);
+		fclose(pFile);
+	}
+
+	return testResult("TraceTest");
+}
@@ -0,0 +1,333 @@
+#include "SdkSim.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <pthread.h>
+
+extern "C"
+{
+	#include <osapi.h>
+	#include <user_interface.h>
+}
+
+namespace
+{
+
+struct Task
+{
+	ETSTask pfnTask;
+	ETSEvent* pQueue;
+	int iLength;
+	int iFirst;
+	int iNrOfEvents;
+};
+
+Task g_arrayTasks[USER_TASK_PRIO_MAX];
+
+// system_os_post() may be called from the thread, which simulates an interrupt handler
+pthread_mutex_t g_mutexTasks = PTHREAD_MUTEX_INITIALIZER;
+
+uint64 g_uNow = 0;
+
+// The armed timers, sorted by their expiry
+os_timer_t* g_pFirstTimer = NULL;
+
+uint32 g_uTimerLatencyUs = 0;
+uint32 g_uNrOfTimerCallbacks = 0;
+
+// The buffer of SdkSim::captureUart(), and the length of the captured output
+char* g_pUartBuffer = NULL;
+unsigned int g_uUartBufferSize = 0;
+unsigned int g_uUartLength = 0;
+
+void removeTimer(os_timer_t* pTimer)
+{
+	for (os_timer_t** ppLink = &g_pFirstTimer; NULL != *ppLink; ppLink = &(*ppLink)->timer_next)
+	{
+		if (*ppLink == pTimer)
+		{
+			*ppLink = pTimer->timer_next;
+			pTimer->timer_next = NULL;
+			return;
+		}
+	}
+}
+
+void insertTimer(os_timer_t* pTimer)
+{
+	os_timer_t** ppLink = &g_pFirstTimer;
+	while (NULL != *ppLink && (*ppLink)->timer_expire <= pTimer->timer_expire)
+	{
+		ppLink = &(*ppLink)->timer_next;
+	}
+	pTimer->timer_next = *ppLink;
+	*ppLink = pTimer;
+}
+
+// Calls the callback of the first timer, if it is due
+bool fireTimer()
+{
+	os_timer_t* pTimer = g_pFirstTimer;
+	if (NULL == pTimer || pTimer->timer_expire > g_uNow)
+	{
+		return false;
+	}
+
+	removeTimer(pTimer);
+	if (0 != pTimer->timer_period)
+	{
+		pTimer->timer_expire += pTimer->timer_period;
+		insertTimer(pTimer);
+	}
+
+	++g_uNrOfTimerCallbacks;
+	g_uNow += g_uTimerLatencyUs;
+	pTimer->timer_func(pTimer->timer_arg);
+	return true;
+}
+
+} // namespace
+
+
+extern "C" bool system_os_task(ETSTask task, uint8 prio, ETSEvent *queue, uint8 qlen)
+{
+	if (prio >= USER_TASK_PRIO_MAX || NULL == queue || 0 == qlen)
+	{
+		return false;
+	}
+
+	pthread_mutex_lock(&g_mutexTasks);
+	Task& t = g_arrayTasks[prio];
+	t.pfnTask = task;
+	t.pQueue = queue;
+	t.iLength = qlen;
+	t.iFirst = 0;
+	t.iNrOfEvents = 0;
+	pthread_mutex_unlock(&g_mutexTasks);
+	return true;
+}
+
+extern "C" bool system_os_post(uint8 prio, ETSSignal sig, ETSParam par)
+{
+	if (prio >= USER_TASK_PRIO_MAX)
+	{
+		return false;
+	}
+
+	bool bPosted = false;
+	pthread_mutex_lock(&g_mutexTasks);
+	Task& t = g_arrayTasks[prio];
+	if (NULL != t.pfnTask && t.iNrOfEvents < t.iLength)
+	{
+		ETSEvent& e = t.pQueue[(t.iFirst + t.iNrOfEvents) % t.iLength];
+		e.sig = sig;
+		e.par = par;
+		++t.iNrOfEvents;
+		bPosted = true;
+	}
+	pthread_mutex_unlock(&g_mutexTasks);
+	return bPosted;
+}
+
+extern "C" uint32 system_get_time(void)
+{
+	return (uint32)g_uNow;
+}
+
+extern "C" void system_timer_reinit(void)
+{
+}
+
+extern "C" void system_soft_wdt_feed(void)
+{
+}
+
+extern "C" void os_timer_disarm(os_timer_t *ptimer)
+{
+	removeTimer(ptimer);
+}
+
+extern "C" void os_timer_setfn(os_timer_t *ptimer, os_timer_func_t *pfunction, void *parg)
+{
+	removeTimer(ptimer);
+	ptimer->timer_func = pfunction;
+	ptimer->timer_arg = parg;
+}
+
+extern "C" void os_timer_arm_us(os_timer_t *ptimer, uint32_t microseconds, bool repeat_flag)
+{
+	removeTimer(ptimer);
+	ptimer->timer_expire = g_uNow + microseconds;
+	ptimer->timer_period = repeat_flag ? microseconds : 0;
+	insertTimer(ptimer);
+}
+
+extern "C" void os_timer_arm(os_timer_t *ptimer, uint32_t milliseconds, bool repeat_flag)
+{
+	removeTimer(ptimer);
+	ptimer->timer_expire = g_uNow + (uint64)milliseconds * 1000;
+	ptimer->timer_period = repeat_flag ? (uint64)milliseconds * 1000 : 0;
+	insertTimer(ptimer);
+}
+
+extern "C" int ets_uart_printf(const char *fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	int iResult = 0;
+	if (NULL != g_pUartBuffer)
+	{
+		iResult = vsnprintf(g_pUartBuffer + g_uUartLength, g_uUartBufferSize - g_uUartLength, fmt, args);
+		g_uUartLength += iResult;
+		if (g_uUartLength >= g_uUartBufferSize)
+		{
+			// the output has been truncated
+			g_uUartLength = g_uUartBufferSize - 1;
+		}
+	}
+	else
+	{
+		iResult = vprintf(fmt, args);
+	}
+	va_end(args);
+	return iResult;
+}
+
+extern "C" int os_printf(const char *fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	int iResult = vprintf(fmt, args);
+	va_end(args);
+	return iResult;
+}
+
+extern "C" int os_sprintf(char *buffer, const char *fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	int iResult = vsprintf(buffer, fmt, args);
+	va_end(args);
+	return iResult;
+}
+
+
+uint64 SdkSim::getTime()
+{
+	return g_uNow;
+}
+
+void SdkSim::advanceTime(uint64 uUs)
+{
+	g_uNow += uUs;
+}
+
+bool SdkSim::runTask()
+{
+	ETSTask pfnTask = NULL;
+	ETSEvent e;
+
+	pthread_mutex_lock(&g_mutexTasks);
+	for (int iPriority = USER_TASK_PRIO_MAX - 1; iPriority >= 0 && NULL == pfnTask; --iPriority)
+	{
+		Task& t = g_arrayTasks[iPriority];
+		if (t.iNrOfEvents > 0)
+		{
+			e = t.pQueue[t.iFirst];
+			t.iFirst = (t.iFirst + 1) % t.iLength;
+			--t.iNrOfEvents;
+			pfnTask = t.pfnTask;
+		}
+	}
+	pthread_mutex_unlock(&g_mutexTasks);
+
+	if (NULL == pfnTask)
+	{
+		return false;
+	}
+
+	pfnTask(&e);
+	return true;
+}
+
+int SdkSim::runTasks()
+{
+	int iNrOfEvents = 0;
+	while (runTask())
+	{
+		++iNrOfEvents;
+	}
+	return iNrOfEvents;
+}
+
+void SdkSim::runUntil(uint64 uTime)
+{
+	while (g_uNow < uTime)
+	{
+		while (fireTimer())
+		{
+		}
+
+		if (runTask())
+		{
+			continue;
+		}
+
+		// idle: sleep until the next expiry
+		if (NULL == g_pFirstTimer || g_pFirstTimer->timer_expire > uTime)
+		{
+			break;
+		}
+		if (g_pFirstTimer->timer_expire > g_uNow)
+		{
+			g_uNow = g_pFirstTimer->timer_expire;
+		}
+	}
+
+	if (g_uNow < uTime)
+	{
+		g_uNow = uTime;
+	}
+	while (fireTimer())
+	{
+	}
+}
+
+int SdkSim::getNrOfPendingEvents(uint8 uPriority)
+{
+	pthread_mutex_lock(&g_mutexTasks);
+	int iNrOfEvents = g_arrayTasks[uPriority].iNrOfEvents;
+	pthread_mutex_unlock(&g_mutexTasks);
+	return iNrOfEvents;
+}
+
+void SdkSim::setTimerLatencyUs(uint32 uUs)
+{
+	g_uTimerLatencyUs = uUs;
+}
+
+uint32 SdkSim::getNrOfTimerCallbacks()
+{
+	return g_uNrOfTimerCallbacks;
+}
+
+int SdkSim::getNrOfArmedTimers()
+{
+	int iNrOfTimers = 0;
+	for (os_timer_t* pTimer = g_pFirstTimer; NULL != pTimer; pTimer = pTimer->timer_next)
+	{
+		++iNrOfTimers;
+	}
+	return iNrOfTimers;
+}
+
+void SdkSim::captureUart(char* pBuffer, unsigned int uSize)
+{
+	g_pUartBuffer = pBuffer;
+	g_uUartBufferSize = uSize;
+	g_uUartLength = 0;
+	if (NULL != pBuffer && uSize > 0)
+	{
+		pBuffer[0] = 0;
+	}
+}
@@ -0,0 +1,59 @@
+#ifndef SDK_SIM_H_INCLUDED
+#define SDK_SIM_H_INCLUDED
+
+extern "C"
+{
+	#include <c_types.h>
+}
+
+/*! \class SdkSim
+    \brief Simulation of the SDK functions used by the library, for the host tests and benchmarks
+
+   The clock is simulated: system_get_time() returns the lower 32 bits of a 64 bit counter, which is only advanced by advanceTime()
+   (a slot, which "works" for some time) and by runUntil(). The tasks (system_os_task()) have the same queues of fixed length as in
+   the SDK, and the os_timers are kept in a sorted list, like in the SDK.
+   Like in the SDK, neither the tasks nor the timer callbacks are preempted: runUntil() calls the timer callbacks, which are due,
+   between two events of the tasks.
+   system_os_post() may be called from another thread (which simulates an interrupt handler), everything else must be called from
+   the thread of the test.
+ */
+class SdkSim
+{
+public:
+
+	//! Returns the simulated time (us)
+	static uint64 getTime();
+
+	//! Advances the simulated time, without calling the tasks or the timers (the caller "works" for uUs)
+	static void advanceTime(uint64 uUs);
+
+	/*! Calls the task of the highest priority, which has a pending event, with its oldest event.
+	    Returns false, if there was no pending event.
+	*/
+	static bool runTask();
+
+	//! Calls the tasks, until there are no pending events. Returns the number of processed events.
+	static int runTasks();
+
+	//! Calls the due timer callbacks and the tasks, until the simulated time reaches uTime (us). The remaining events stay pending.
+	static void runUntil(uint64 uTime);
+
+	//! Returns the number of the pending events of the task with the given priority (USER_TASK_PRIO_0..2)
+	static int getNrOfPendingEvents(uint8 uPriority);
+
+	//! The simulated interrupt latency: the time between the expiry of an os_timer and the start of its callback
+	static void setTimerLatencyUs(uint32 uUs);
+
+	//! Returns the number of the calls of the os_timer callbacks (the number of wake ups)
+	static uint32 getNrOfTimerCallbacks();
+
+	//! Returns the number of the armed os_timers (the length of the sorted list)
+	static int getNrOfArmedTimers();
+
+	/*! The output of ets_uart_printf() (print() and printError() of the library) is appended to pBuffer (uSize bytes, always
+	    terminated by zero) instead of stdout. captureUart(NULL, 0) prints to stdout again.
+	*/
+	static void captureUart(char* pBuffer, unsigned int uSize);
+};
+
+#endif
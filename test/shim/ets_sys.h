@@ -0,0 +1,29 @@
+/* Host shim of the SDK header: timers and events. The fields are only used by SdkSim. */
+#ifndef _ETS_SYS_H
+#define _ETS_SYS_H
+
+#include "c_types.h"
+
+typedef void ETSTimerFunc(void *timer_arg);
+
+typedef struct _ETSTIMER_
+{
+	struct _ETSTIMER_ *timer_next;
+	uint64_t timer_expire;  /* simulated time of the expiry (us), 64 bits, so that the maximum delay of os_timer_arm() fits */
+	uint64_t timer_period;  /* us, 0 for a single-shot timer */
+	ETSTimerFunc *timer_func;
+	void *timer_arg;
+} ETSTimer;
+
+typedef uint32_t ETSSignal;
+typedef uint32_t ETSParam;
+
+typedef struct ETSEventTag
+{
+	ETSSignal sig;
+	ETSParam par;
+} ETSEvent;
+
+typedef void (*ETSTask)(ETSEvent *e);
+
+#endif
@@ -0,0 +1,11 @@
+/* Host shim of the SDK header: the heap. */
+#ifndef __MEM_H__
+#define __MEM_H__
+
+#include <stdlib.h>
+
+#define os_malloc malloc
+#define os_zalloc(size) calloc(1, size)
+#define os_free free
+
+#endif
@@ -0,0 +1,31 @@
+/* Host shim of the SDK header: os_timer and the os_ helpers. */
+#ifndef _OSAPI_H_
+#define _OSAPI_H_
+
+#include <string.h>
+#include "c_types.h"
+#include "ets_sys.h"
+#include "user_interface.h"
+
+typedef ETSTimer os_timer_t;
+typedef ETSTimerFunc os_timer_func_t;
+typedef ETSEvent os_event_t;
+typedef ETSTask os_task_t;
+typedef ETSSignal os_signal_t;
+typedef ETSParam os_param_t;
+
+void os_timer_disarm(os_timer_t *ptimer);
+void os_timer_setfn(os_timer_t *ptimer, os_timer_func_t *pfunction, void *parg);
+void os_timer_arm(os_timer_t *ptimer, uint32_t milliseconds, bool repeat_flag);
+void os_timer_arm_us(os_timer_t *ptimer, uint32_t microseconds, bool repeat_flag);
+
+int os_printf(const char *fmt, ...);
+int os_sprintf(char *buffer, const char *fmt, ...);
+
+#define os_memcpy memcpy
+#define os_memset memset
+#define os_memcmp memcmp
+#define os_strlen strlen
+#define os_strcpy strcpy
+
+#endif
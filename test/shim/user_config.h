@@ -0,0 +1 @@
+/* Host shim of the application configuration: the tests set the configuration macros of the library on the command line. */
@@ -0,0 +1,20 @@
+/* Host shim of the SDK header: the tasks and the system time. */
+#ifndef __USER_INTERFACE_H__
+#define __USER_INTERFACE_H__
+
+#include "c_types.h"
+#include "ets_sys.h"
+
+#define USER_TASK_PRIO_0 0
+#define USER_TASK_PRIO_1 1
+#define USER_TASK_PRIO_2 2
+#define USER_TASK_PRIO_MAX 3
+
+bool system_os_task(ETSTask task, uint8 prio, ETSEvent *queue, uint8 qlen);
+bool system_os_post(uint8 prio, ETSSignal sig, ETSParam par);
+
+uint32 system_get_time(void);
+void system_timer_reinit(void);
+void system_soft_wdt_feed(void);
+
+#endif
@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""Converts the output of Esp8266Base::Trace::dump() into a timeline.
+
+Usage: decode_trace.py [uart-log-file]   (reads stdin, if no file is given)
+
+The UART log may contain other output too: only the lines between "TRACE BEGIN" and "TRACE END" are decoded.
+Each line of the timeline shows the time since the first record, the time since the previous record, the event,
+the object pointer and the argument.
+"""
+
+import sys
+
+# the same ids as Trace::Event in lib/Trace.h
+EVENT_NAMES = {
+    1: "SignalEmit",
+    2: "TaskInvokeSlotStart",
+    3: "TaskInvokeSlotEnd",
+    4: "TimerExpired",
+    5: "EspNowReceived",
+    6: "EspNowSent",
+}
+FIRST_USER_EVENT = 0x100
+
+# the sig of the events of the task of the queued signals (see Signal.cpp)
+TASK_EVENT_NAMES = {1928: "INVOKE_SLOT", 1929: "EMIT_FROM_ISR"}
+PRIORITY_NAMES = {0: "low", 1: "medium", 2: "high"}
+
+
+def event_name(event):
+    if event >= FIRST_USER_EVENT:
+        return "User+%d" % (event - FIRST_USER_EVENT)
+    return EVENT_NAMES.get(event, "Unknown(%d)" % event)
+
+
+def argument_text(event, argument):
+    if event in (2, 3):
+        sig, par = argument >> 16, argument & 0xffff
+        text = TASK_EVENT_NAMES.get(sig, str(sig))
+        if sig == 1928:
+            text += " " + PRIORITY_NAMES.get(par, str(par))
+        return text
+    if event == 4:
+        # signed 32 bit jitter of the timer
+        return "jitter %+d us" % (argument - (1 << 32) if argument & 0x80000000 else argument)
+    return "0x%x" % argument
+
+
+def parse(lines):
+    """Returns the list of (timestamp, event, object, argument) tuples of the last dump in the lines."""
+    last_dump = []
+    records = None
+    for line in lines:
+        line = line.strip()
+        if line.startswith("TRACE BEGIN"):
+            records = []
+        elif line.startswith("TRACE END"):
+            if records is not None:
+                last_dump = records
+            records = None
+        elif records is not None and line.startswith("TR ") and len(line) == 35:
+            words = line[3:]
+            records.append(tuple(int(words[i:i + 8], 16) for i in range(0, 32, 8)))
+    return last_dump
+
+
+def main():
+    source = open(sys.argv[1], errors="replace") if len(sys.argv) > 1 else sys.stdin
+    records = parse(source)
+    if not records:
+        sys.exit("no trace found (expected the output of Trace::dump())")
+
+    first = previous = records[0][0]
+    print("%12s %10s  %-20s %-10s %s" % ("time [us]", "delta", "event", "object", "argument"))
+    for timestamp, event, obj, argument in records:
+        # system_get_time() wraps around after 71 minutes, the differences are computed modulo 2^32
+        print("%12d %+10d  %-20s 0x%08x %s" % ((timestamp - first) & 0xffffffff, (timestamp - previous) & 0xffffffff,
+                                                event_name(event), obj, argument_text(event, argument)))
+        previous = timestamp
+
+
+if __name__ == "__main__":
+    main()